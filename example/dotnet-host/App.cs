@@ -40,6 +40,26 @@ namespace FlutterApplication
         {
             public string assets_path;
             public string icu_data_path;
+            public int vsync_source;
+            public double vsync_timer_rate;
+            public int vsync_phase_offset;
+            [MarshalAs(UnmanagedType.I1)]
+            public bool vsync_adaptive_phase;
+            public string render_thread_name;
+            public int render_thread_priority;
+            public int render_thread_nice;
+            public ulong render_thread_cpu_mask;
+            public int renderer;
+            public int software_pixel_format;
+            public int surface_format;
+            public int surface_depth_bits;
+            public int surface_stencil_bits;
+            public double render_scale_min;
+            public int render_scale_frame_budget;
+            public int pointer_batching;
+            [MarshalAs(UnmanagedType.I1)]
+            public bool touch_resampling;
+            public int touch_prediction;
         }
 
         [DllImport("flutter_embedder.so")]
@@ -51,6 +71,12 @@ namespace FlutterApplication
 
         [DllImport("flutter_embedder.so")]
         internal static extern IntPtr StopFlutterApplication(IntPtr /*FlutterApplicationRef*/ application);
+
+        [DllImport("flutter_embedder.so")]
+        internal static extern bool ResumeFlutterApplication(IntPtr /*FlutterApplicationRef*/ application);
+
+        [DllImport("flutter_embedder.so")]
+        internal static extern bool PauseFlutterApplication(IntPtr /*FlutterApplicationRef*/ application);
         #endregion
 
         #region flutter_embedder.h
@@ -128,6 +154,26 @@ namespace FlutterApplication
             }
         }
 
+        protected override void OnResume()
+        {
+            base.OnResume();
+
+            if (Instance != IntPtr.Zero)
+            {
+                ResumeFlutterApplication(Instance);
+            }
+        }
+
+        protected override void OnPause()
+        {
+            base.OnPause();
+
+            if (Instance != IntPtr.Zero)
+            {
+                PauseFlutterApplication(Instance);
+            }
+        }
+
         protected override void OnTerminate()
         {
             base.OnTerminate();
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "backing_store_pool.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+namespace flutter
+{
+  static int32_t RoundUpToBucket(int32_t size, int32_t bucket)
+  {
+    return (size + bucket - 1) / bucket * bucket;
+  }
+
+  BackingStorePool::BackingStorePool(size_t max_pooled_bytes) : max_pooled_bytes_(max_pooled_bytes)
+  {
+    free_entries_.reserve(8);
+    used_entries_.reserve(8);
+  }
+
+  BackingStorePool::~BackingStorePool()
+  {
+    for (Entry *entry : free_entries_)
+    {
+      Free(entry);
+    }
+    free_entries_.clear();
+    for (Entry *entry : used_entries_)
+    {
+      Free(entry);
+    }
+    used_entries_.clear();
+  }
+
+  BackingStorePool::Entry *BackingStorePool::Acquire(int32_t width, int32_t height)
+  {
+    int32_t bucket_width = RoundUpToBucket(width, kBucketSize);
+    int32_t bucket_height = RoundUpToBucket(height, kBucketSize);
+
+    // Prefer the most recently used match, whose memory is most likely warm.
+    for (size_t i = free_entries_.size(); i > 0; i--)
+    {
+      Entry *entry = free_entries_[i - 1];
+      if (entry->width == bucket_width && entry->height == bucket_height)
+      {
+        free_entries_.erase(free_entries_.begin() + (i - 1));
+        pooled_bytes_ -= GetBytes(*entry);
+        entry->content_width = width;
+        entry->content_height = height;
+        used_entries_.push_back(entry);
+        return entry;
+      }
+    }
+
+    Entry *entry = Allocate(bucket_width, bucket_height);
+    if (entry)
+    {
+      entry->content_width = width;
+      entry->content_height = height;
+      used_entries_.push_back(entry);
+    }
+    return entry;
+  }
+
+  void BackingStorePool::Release(Entry *entry)
+  {
+    auto used = std::find(used_entries_.begin(), used_entries_.end(), entry);
+    if (used != used_entries_.end())
+    {
+      used_entries_.erase(used);
+    }
+    entry->last_used_frame = frame_;
+    free_entries_.push_back(entry);
+    pooled_bytes_ += GetBytes(*entry);
+  }
+
+  void BackingStorePool::Trim()
+  {
+    frame_++;
+
+    size_t evict_count = 0;
+    size_t pooled_bytes = pooled_bytes_;
+    for (Entry *entry : free_entries_)
+    {
+      bool idle = frame_ - entry->last_used_frame > kMaxIdleFrames;
+      if (!idle && pooled_bytes <= max_pooled_bytes_)
+      {
+        break;
+      }
+      pooled_bytes -= GetBytes(*entry);
+      evict_count++;
+    }
+
+    for (size_t i = 0; i < evict_count; i++)
+    {
+      Free(free_entries_[i]);
+    }
+    free_entries_.erase(free_entries_.begin(), free_entries_.begin() + evict_count);
+    pooled_bytes_ = pooled_bytes;
+  }
+
+  size_t BackingStorePool::GetAllocatedBytes() const { return allocated_bytes_; }
+
+  size_t BackingStorePool::GetPooledBytes() const { return pooled_bytes_; }
+
+  uint64_t BackingStorePool::GetAllocationCount() const { return allocation_count_; }
+
+  BackingStorePool::Entry *BackingStorePool::Allocate(int32_t width, int32_t height)
+  {
+    auto *entry = new Entry();
+    entry->width = width;
+    entry->height = height;
+
+    glGenTextures(1, &entry->texture);
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &entry->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, entry->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, entry->texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+      LogE("Could not create a %dx%d backing store framebuffer (0x%x).", width, height, status);
+      glDeleteFramebuffers(1, &entry->framebuffer);
+      glDeleteTextures(1, &entry->texture);
+      delete entry;
+      return nullptr;
+    }
+
+    allocated_bytes_ += GetBytes(*entry);
+    allocation_count_++;
+    return entry;
+  }
+
+  void BackingStorePool::Free(Entry *entry)
+  {
+    allocated_bytes_ -= GetBytes(*entry);
+    glDeleteFramebuffers(1, &entry->framebuffer);
+    glDeleteTextures(1, &entry->texture);
+    delete entry;
+  }
+
+  size_t BackingStorePool::GetBytes(const Entry &entry)
+  {
+    return static_cast<size_t>(entry.width) * entry.height * 4;
+  }
+
+} // namespace flutter
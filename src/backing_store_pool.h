@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter
+{
+  // Recycles the textures and framebuffers that back compositor layers, so that
+  // steady-state frames do not allocate GPU memory. Sizes are rounded up to
+  // buckets so that slightly different layer sizes share allocations. Must be
+  // used on a single thread with the owning context current.
+  class BackingStorePool
+  {
+  public:
+    struct Entry
+    {
+      GLuint texture = 0;
+      GLuint framebuffer = 0;
+      // The allocated size, a multiple of the bucket size.
+      int32_t width = 0;
+      int32_t height = 0;
+      // The size the current user renders into, anchored at the bottom left.
+      int32_t content_width = 0;
+      int32_t content_height = 0;
+      uint64_t last_used_frame = 0;
+    };
+
+    // At most |max_pooled_bytes| are kept around in unused entries.
+    explicit BackingStorePool(size_t max_pooled_bytes);
+    ~BackingStorePool();
+
+    Entry *Acquire(int32_t width, int32_t height);
+    void Release(Entry *entry);
+
+    // Ends a frame, freeing entries that have not been used for a while and
+    // then the least recently used ones until the pool is within budget.
+    void Trim();
+
+    size_t GetAllocatedBytes() const;
+    size_t GetPooledBytes() const;
+    uint64_t GetAllocationCount() const;
+
+  private:
+    static constexpr int32_t kBucketSize = 64;
+    static constexpr uint64_t kMaxIdleFrames = 120;
+
+    size_t max_pooled_bytes_;
+    uint64_t frame_ = 0;
+    // Unused entries, least recently used first.
+    std::vector<Entry *> free_entries_;
+    // Entries acquired and not yet released, freed with the pool if the engine
+    // never collects them.
+    std::vector<Entry *> used_entries_;
+
+    std::atomic<size_t> allocated_bytes_{0};
+    std::atomic<size_t> pooled_bytes_{0};
+    std::atomic<uint64_t> allocation_count_{0};
+
+    Entry *Allocate(int32_t width, int32_t height);
+    void Free(Entry *entry);
+    static size_t GetBytes(const Entry &entry);
+
+    // Disallow copy and assign operations.
+    BackingStorePool(const BackingStorePool &) = delete;
+    void operator=(const BackingStorePool &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "external_texture.h"
+
+#include "logger.h"
+
+namespace flutter
+{
+  ExternalTexture::ExternalTexture(int64_t texture_id, FlutterApplication::RenderDelegate &render_delegate)
+      : texture_id_(texture_id), render_delegate_(render_delegate)
+  {
+    image_target_texture_ = reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(
+        render_delegate_.GetProcAddress("glEGLImageTargetTexture2DOES"));
+    if (!image_target_texture_)
+    {
+      LogE("glEGLImageTargetTexture2DOES is not available.");
+    }
+  }
+
+  ExternalTexture::~ExternalTexture()
+  {
+    for (Slot &slot : slots_)
+    {
+      ReleaseSlot(slot);
+    }
+
+    if (texture_)
+    {
+      glDeleteTextures(1, &texture_);
+      texture_ = 0;
+    }
+  }
+
+  int64_t ExternalTexture::GetId() const { return texture_id_; }
+
+  void ExternalTexture::PushBuffer(const FlutterDesktopExternalBuffer &buffer)
+  {
+    Slot &slot = slots_[producer_index_];
+    slot.buffer = buffer;
+    slot.has_buffer = true;
+    slot.image = nullptr;
+
+    // Publish the frame and take back either a frame that was never drawn or
+    // one the raster thread is done with. Both are released here.
+    uint32_t previous = shared_index_.exchange(producer_index_ | kFreshBit, std::memory_order_acq_rel);
+    producer_index_ = previous & kIndexMask;
+    ReleaseSlot(slots_[producer_index_]);
+  }
+
+  bool ExternalTexture::PopulateTexture(FlutterOpenGLTexture *texture_out)
+  {
+    if (!image_target_texture_)
+    {
+      return false;
+    }
+
+    if (shared_index_.load(std::memory_order_acquire) & kFreshBit)
+    {
+      uint32_t next = shared_index_.exchange(retired_index_, std::memory_order_acq_rel) & kIndexMask;
+      retired_index_ = front_index_;
+      front_index_ = next;
+
+      Slot &front = slots_[front_index_];
+      front.image = render_delegate_.OnApplicationCreateExternalImage(front.buffer);
+      if (!front.image)
+      {
+        LogE("Could not import a frame of external texture %lld.", static_cast<long long>(texture_id_));
+      }
+      else
+      {
+        if (!texture_)
+        {
+          glGenTextures(1, &texture_);
+          glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture_);
+          glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+          glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+          glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+          glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        else
+        {
+          glBindTexture(GL_TEXTURE_EXTERNAL_OES, texture_);
+        }
+        // The texture keeps pointing at the buffer itself, with no copy.
+        image_target_texture_(GL_TEXTURE_EXTERNAL_OES, front.image);
+        glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
+      }
+    }
+
+    const Slot &front = slots_[front_index_];
+    if (!front.image)
+    {
+      return false;
+    }
+
+    texture_out->target = GL_TEXTURE_EXTERNAL_OES;
+    texture_out->name = texture_;
+    texture_out->format = GL_RGBA8_OES;
+    texture_out->width = front.buffer.width;
+    texture_out->height = front.buffer.height;
+    texture_out->user_data = nullptr;
+    // The texture is owned by this object, not by each frame.
+    texture_out->destruction_callback = [](void *) {};
+    return true;
+  }
+
+  void ExternalTexture::ReleaseSlot(Slot &slot)
+  {
+    if (slot.image)
+    {
+      render_delegate_.OnApplicationDestroyExternalImage(slot.image);
+      slot.image = nullptr;
+    }
+
+    if (slot.has_buffer)
+    {
+      if (slot.buffer.release_callback)
+      {
+        slot.buffer.release_callback(slot.buffer.release_user_data);
+      }
+      slot.has_buffer = false;
+    }
+  }
+
+} // namespace flutter
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <atomic>
+
+#include "flutter_application.h"
+#include "flutter_tizen.h"
+
+namespace flutter
+{
+  // Hands frames of an external producer to the raster thread without either
+  // side waiting for the other. Frames move through four slots: one written by
+  // the producer, one exchanged between the threads through an atomic index,
+  // and two owned by the raster thread, the one being shown and the one shown
+  // before it. The latter may still be read by the GPU and is only handed back,
+  // and released by the producer, once the frame after it is shown.
+  class ExternalTexture
+  {
+  public:
+    ExternalTexture(int64_t texture_id, FlutterApplication::RenderDelegate &render_delegate);
+    // Deletes the GL texture, so it must be destroyed on the render thread
+    // with a context current.
+    ~ExternalTexture();
+
+    int64_t GetId() const;
+
+    // Called on the producer thread.
+    void PushBuffer(const FlutterDesktopExternalBuffer &buffer);
+
+    // Called on the render thread.
+    bool PopulateTexture(FlutterOpenGLTexture *texture_out);
+
+  private:
+    struct Slot
+    {
+      FlutterDesktopExternalBuffer buffer;
+      bool has_buffer;
+      void *image;
+    };
+
+    static constexpr uint32_t kSlotCount = 4;
+    static constexpr uint32_t kIndexMask = 0x3;
+    // Set on the shared index when it holds a frame not yet taken by the raster
+    // thread.
+    static constexpr uint32_t kFreshBit = 0x4;
+
+    int64_t texture_id_;
+    FlutterApplication::RenderDelegate &render_delegate_;
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC image_target_texture_ = nullptr;
+
+    Slot slots_[kSlotCount] = {};
+    std::atomic<uint32_t> shared_index_{3};
+    uint32_t producer_index_ = 0;
+    uint32_t front_index_ = 1;
+    uint32_t retired_index_ = 2;
+
+    GLuint texture_ = 0;
+
+    void ReleaseSlot(Slot &slot);
+
+    // Disallow copy and assign operations.
+    ExternalTexture(const ExternalTexture &) = delete;
+    void operator=(const ExternalTexture &) = delete;
+  };
+
+} // namespace flutter
@@ -8,9 +8,12 @@
 #include <unistd.h>
 #include <chrono>
 #include <climits>
+#include <cmath>
+#include <cstring>
 #include <sstream>
 #include <vector>
 
+#include "external_texture.h"
 #include "logger.h"
 
 namespace flutter
@@ -21,9 +24,16 @@ namespace flutter
       std::string bundle_path,
       std::string icu_data_path,
       const std::vector<const char*> &command_line_args,
+      std::unique_ptr<VsyncWaiter> vsync_waiter,
+      std::unique_ptr<RenderTaskRunner> render_task_runner,
+      std::unique_ptr<RenderScaleController> render_scale,
+      FlutterDesktopPointerBatching pointer_batching,
+      std::unique_ptr<PointerResampler> touch_resampler,
       RenderDelegate &render_delegate)
       : render_delegate_(render_delegate),
-        vsync_waiter_(std::make_unique<VsyncWaiter>())
+        render_task_runner_(std::move(render_task_runner)),
+        vsync_waiter_(std::move(vsync_waiter)),
+        render_scale_(std::move(render_scale))
   {
     if (::access(bundle_path.c_str(), R_OK) != 0)
     {
@@ -38,26 +48,59 @@ namespace flutter
     }
 
     FlutterRendererConfig config = {};
-    config.type = kOpenGL;
-    config.open_gl.struct_size = sizeof(config.open_gl);
-    config.open_gl.make_current = [](void *data) -> bool {
-      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationContextMakeCurrent();
-    };
-    config.open_gl.make_resource_current = [](void *data) -> bool {
-      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationContextMakeResourceCurrent();
-    };
-    config.open_gl.clear_current = [](void *data) -> bool {
-      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationContextClearCurrent();
-    };
-    config.open_gl.present = [](void *data) -> bool {
-      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationPresent();
-    };
-    config.open_gl.fbo_callback = [](void *data) -> uint32_t {
-      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationGetOnscreenFBO();
-    };
-    config.open_gl.gl_proc_resolver = [](void *data, const char *name) -> void * {
-      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.GetProcAddress(name);
-    };
+    if (render_delegate_.GetRendererType() == kSoftware)
+    {
+      config.type = kSoftware;
+      config.software.struct_size = sizeof(config.software);
+      config.software.surface_present_callback = [](void *data, const void *allocation, size_t row_bytes, size_t height) -> bool {
+        auto *app = reinterpret_cast<FlutterApplication *>(data);
+        if (app->presentation_suspended_)
+        {
+          return true;
+        }
+        bool result = app->render_delegate_.OnApplicationPresentSoftware(allocation, row_bytes, height);
+        app->vsync_waiter_->OnFramePresented(FlutterEngineGetCurrentTime());
+        if (!result)
+        {
+          // Buffers are released through the main loop, so that is where the
+          // held back frame is retried from.
+          char wakeup = 0;
+          ecore_pipe_write(app->held_frame_pipe_, &wakeup, sizeof(wakeup));
+        }
+        return result;
+      };
+    }
+    else
+    {
+      config.type = kOpenGL;
+      config.open_gl.struct_size = sizeof(config.open_gl);
+      config.open_gl.make_current = [](void *data) -> bool {
+        return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationContextMakeCurrent();
+      };
+      config.open_gl.make_resource_current = [](void *data) -> bool {
+        return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationContextMakeResourceCurrent();
+      };
+      config.open_gl.clear_current = [](void *data) -> bool {
+        return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationContextClearCurrent();
+      };
+      config.open_gl.present = [](void *data) -> bool {
+        // Frames are presented through the compositor below.
+        return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationPresent();
+      };
+      config.open_gl.fbo_callback = [](void *data) -> uint32_t {
+        return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationGetOnscreenFBO();
+      };
+      config.open_gl.surface_transformation = [](void *data) -> FlutterTransformation {
+        return reinterpret_cast<FlutterApplication *>(data)->GetSurfaceTransformation();
+      };
+      config.open_gl.gl_proc_resolver = [](void *data, const char *name) -> void * {
+        return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.GetProcAddress(name);
+      };
+      config.open_gl.gl_external_texture_frame_callback = [](void *data, int64_t texture_id, size_t width, size_t height,
+                                                             FlutterOpenGLTexture *texture_out) -> bool {
+        return reinterpret_cast<FlutterApplication *>(data)->PopulateExternalTexture(texture_id, texture_out);
+      };
+    }
 
     FlutterProjectArgs args = {
         .struct_size = sizeof(FlutterProjectArgs),
@@ -69,8 +112,109 @@ namespace flutter
           reinterpret_cast<FlutterApplication *>(data)->vsync_waiter_->AsyncWaitForVsync(baton);
         },
     };
+    args.platform_message_callback = [](const FlutterPlatformMessage *message, void *data) -> void {
+      reinterpret_cast<FlutterApplication *>(data)->OnPlatformMessage(message);
+    };
+
+    FlutterCompositor compositor = {};
+    compositor.struct_size = sizeof(FlutterCompositor);
+    compositor.user_data = this;
+    compositor.create_backing_store_callback = [](const FlutterBackingStoreConfig *config,
+                                                  FlutterBackingStore *backing_store_out,
+                                                  void *data) -> bool {
+      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationCreateBackingStore(*config, backing_store_out);
+    };
+    compositor.collect_backing_store_callback = [](const FlutterBackingStore *backing_store, void *data) -> bool {
+      return reinterpret_cast<FlutterApplication *>(data)->render_delegate_.OnApplicationCollectBackingStore(*backing_store);
+    };
+    compositor.present_layers_callback = [](const FlutterLayer **layers, size_t layers_count, void *data) -> bool {
+      auto *app = reinterpret_cast<FlutterApplication *>(data);
+      if (app->presentation_suspended_)
+      {
+        // Nothing is visible, so drop the frame. The engine redraws on resume.
+        app->render_delegate_.OnApplicationFrameDropped();
+        return true;
+      }
+      // Everything up to here in the current render task is rasterization.
+      uint64_t raster_time = FlutterEngineGetCurrentTime() - app->render_task_runner_->GetCurrentTaskStartTime();
+      bool result = app->render_delegate_.OnApplicationPresentLayers(layers, layers_count);
+      app->vsync_waiter_->OnFramePresented(FlutterEngineGetCurrentTime());
+      if (app->render_scale_ && app->render_scale_->OnFrameRasterized(raster_time))
+      {
+        // Window metrics can only be sent on the platform thread.
+        char wakeup = 0;
+        ecore_pipe_write(app->metrics_pipe_, &wakeup, sizeof(wakeup));
+      }
+      return result;
+    };
+    // Layers are composited with GL, so the software renderer presents the
+    // whole frame through its own callback instead.
+    if (config.type == kOpenGL)
+    {
+      args.compositor = &compositor;
+    }
 
-    auto result = FlutterEngineRun(FLUTTER_ENGINE_VERSION, &config, &args, this, &engine_);
+    if (render_scale_)
+    {
+      metrics_pipe_ = ecore_pipe_add([](void *data, void *, unsigned int) -> void {
+        reinterpret_cast<FlutterApplication *>(data)->SendWindowMetrics();
+      }, this);
+      if (!metrics_pipe_)
+      {
+        LogE("Could not create the window metrics pipe.");
+        return;
+      }
+    }
+
+    if (config.type == kSoftware)
+    {
+      held_frame_pipe_ = ecore_pipe_add([](void *data, void *, unsigned int) -> void {
+        auto *app = reinterpret_cast<FlutterApplication *>(data);
+        if (!app->held_frame_timer_)
+        {
+          app->held_frame_timer_ = ecore_timer_add(kHeldFrameRetryInterval, OnHeldFrameTimer, app);
+        }
+      }, this);
+      if (!held_frame_pipe_)
+      {
+        LogE("Could not create the held frame pipe.");
+        return;
+      }
+    }
+
+    // Platform tasks run on the ecore main loop, which is the thread this is
+    // created on.
+    platform_task_runner_ = std::make_unique<PlatformTaskRunner>();
+    if (!platform_task_runner_->IsValid())
+    {
+      LogE("Could not create the platform task runner.");
+      return;
+    }
+
+    FlutterCustomTaskRunners custom_task_runners = {};
+    custom_task_runners.struct_size = sizeof(FlutterCustomTaskRunners);
+    custom_task_runners.platform_task_runner = platform_task_runner_->GetDescription();
+    // Raster tasks, and so all onscreen context callbacks, stay on one thread.
+    custom_task_runners.render_task_runner = render_task_runner_->GetDescription();
+    args.custom_task_runners = &custom_task_runners;
+
+    auto result = FlutterEngineInitialize(FLUTTER_ENGINE_VERSION, &config, &args, this, &engine_);
+    if (result != kSuccess)
+    {
+      LogE("Could not initialize the Flutter engine.");
+      return;
+    }
+
+    // The runners need the engine handle before the first task is posted.
+    platform_task_runner_->SetEngine(engine_);
+    render_task_runner_->SetEngine(engine_);
+
+    // Platform messages can arrive as soon as the engine runs.
+    key_event_channel_ = std::make_unique<KeyEventChannel>(
+        engine_, [this](const KeyEventChannel::KeyEvent &event) { OnUnhandledKeyEvent(event); });
+    text_input_channel_ = std::make_unique<TextInputChannel>(engine_);
+
+    result = FlutterEngineRunInitialized(engine_);
     if (result != kSuccess)
     {
       LogE("Could not start the Flutter engine.");
@@ -79,9 +223,24 @@ namespace flutter
 
     vsync_waiter_->AsyncWaitForRunEngineSuccess(engine_);
 
+    pointer_queue_ = std::make_unique<PointerEventQueue>(engine_, pointer_batching, std::move(touch_resampler));
+    if (!pointer_queue_->IsValid())
+    {
+      LogE("Could not create the pointer event queue.");
+      return;
+    }
+    if (pointer_batching == kFlutterDesktopPointerBatchingVsync)
+    {
+      vsync_waiter_->SetObserver(pointer_queue_.get());
+    }
+
     pointer_event_handlers_.push_back(ecore_event_handler_add(ECORE_EVENT_MOUSE_BUTTON_DOWN, OnPointerEvent, this));
     pointer_event_handlers_.push_back(ecore_event_handler_add(ECORE_EVENT_MOUSE_BUTTON_UP, OnPointerEvent, this));
     pointer_event_handlers_.push_back(ecore_event_handler_add(ECORE_EVENT_MOUSE_MOVE, OnPointerEvent, this));
+    pointer_event_handlers_.push_back(ecore_event_handler_add(ECORE_EVENT_MOUSE_WHEEL, OnScrollEvent, this));
+    pointer_event_handlers_.push_back(ecore_event_handler_add(ECORE_EVENT_DETENT_ROTATE, OnScrollEvent, this));
+    key_event_handlers_.push_back(ecore_event_handler_add(ECORE_EVENT_KEY_DOWN, OnKeyEvent, this));
+    key_event_handlers_.push_back(ecore_event_handler_add(ECORE_EVENT_KEY_UP, OnKeyEvent, this));
 
     valid_ = true;
   }
@@ -90,55 +249,519 @@ namespace flutter
 
   bool FlutterApplication::SetWindowSize(size_t width, size_t height)
   {
+    window_width_ = width;
+    window_height_ = height;
+    return SendWindowMetrics();
+  }
+
+  bool FlutterApplication::SetRotation(int32_t degrees)
+  {
+    degrees = ((degrees % 360) + 360) % 360;
+    if (degrees % 90 != 0)
+    {
+      LogE("Cannot rotate by %d degrees.", degrees);
+      return false;
+    }
+    if (degrees == rotation_)
+    {
+      return true;
+    }
+
+    rotation_ = degrees;
+    // The buffer is rotated on the render thread, between two frames and
+    // together with the transformation the following frames are drawn with.
+    PostRenderThreadTask([this, degrees]() {
+      render_delegate_.OnApplicationSetBufferRotation(degrees);
+      surface_rotation_ = degrees;
+    });
+    // Turning upside down keeps the metrics, which are still sent so that the
+    // engine draws a frame with the new transformation. That does not cause a
+    // new layout.
+    return SendWindowMetrics(true);
+  }
+
+  bool FlutterApplication::SendWindowMetrics(bool force)
+  {
+    // While the render scale is reduced, the engine renders a smaller frame
+    // with the same logical size, which the compositor stretches to the
+    // window.
+    metrics_scale_ = render_scale_ ? render_scale_->GetScale() : 1.0;
+    double frame_width = std::round(window_width_ * metrics_scale_);
+    double frame_height = std::round(window_height_ * metrics_scale_);
+    bool sideways = rotation_ == 90 || rotation_ == 270;
+
     FlutterWindowMetricsEvent event = {};
     event.struct_size = sizeof(event);
-    event.width = width;
-    event.height = height;
-    event.pixel_ratio = 1.5; // screen density
+    event.width = static_cast<size_t>(sideways ? frame_height : frame_width);
+    event.height = static_cast<size_t>(sideways ? frame_width : frame_height);
+    event.pixel_ratio = 1.5 * metrics_scale_; // screen density
+
+    frame_width_ = frame_width;
+    frame_height_ = frame_height;
+    if (!force && event.width == last_metrics_.width && event.height == last_metrics_.height &&
+        event.pixel_ratio == last_metrics_.pixel_ratio)
+    {
+      return true;
+    }
+    last_metrics_ = event;
     return FlutterEngineSendWindowMetricsEvent(engine_, &event) == kSuccess;
   }
 
-  void FlutterApplication::SendFlutterPointerEvent(FlutterPointerPhase phase, double x, double y, size_t timestamp)
+  FlutterTransformation FlutterApplication::GetSurfaceTransformation() const
+  {
+    // Maps the frame, as laid out by the app, onto the window buffer.
+    double width = frame_width_;
+    double height = frame_height_;
+    switch (surface_rotation_)
+    {
+    case 90:
+      return {0, 1, 0, -1, 0, height, 0, 0, 1};
+    case 180:
+      return {-1, 0, width, 0, -1, height, 0, 0, 1};
+    case 270:
+      return {0, -1, width, 1, 0, 0, 0, 0, 1};
+    default:
+      return {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    }
+  }
+
+  bool FlutterApplication::Resume()
+  {
+    presentation_suspended_ = false;
+    vsync_waiter_->Resume();
+    return SendLifecycleMessage("AppLifecycleState.resumed");
+  }
+
+  bool FlutterApplication::Inactivate()
+  {
+    // Still visible, so keep rendering.
+    presentation_suspended_ = false;
+    vsync_waiter_->Resume();
+    return SendLifecycleMessage("AppLifecycleState.inactive");
+  }
+
+  bool FlutterApplication::Pause()
+  {
+    // Let the framework know first so that it stops scheduling frames.
+    bool result = SendLifecycleMessage("AppLifecycleState.paused");
+    vsync_waiter_->Pause();
+    presentation_suspended_ = true;
+    return result;
+  }
+
+  std::shared_ptr<ExternalTexture> FlutterApplication::RegisterExternalTexture()
+  {
+    std::lock_guard<std::mutex> lock(external_textures_mutex_);
+
+    int64_t texture_id = next_external_texture_id_++;
+    if (FlutterEngineRegisterExternalTexture(engine_, texture_id) != kSuccess)
+    {
+      LogE("Could not register external texture %lld.", static_cast<long long>(texture_id));
+      return nullptr;
+    }
+
+    auto texture = std::make_shared<ExternalTexture>(texture_id, render_delegate_);
+    external_textures_[texture_id] = texture;
+    return texture;
+  }
+
+  bool FlutterApplication::MarkExternalTextureFrameAvailable(int64_t texture_id)
+  {
+    return FlutterEngineMarkExternalTextureFrameAvailable(engine_, texture_id) == kSuccess;
+  }
+
+  bool FlutterApplication::UnregisterExternalTexture(std::shared_ptr<ExternalTexture> texture)
+  {
+    {
+      std::lock_guard<std::mutex> lock(external_textures_mutex_);
+      external_textures_.erase(texture->GetId());
+    }
+
+    bool result = FlutterEngineUnregisterExternalTexture(engine_, texture->GetId()) == kSuccess;
+
+    // The texture owns a GL texture, so release the last reference on the
+    // render thread. Any frame callback in flight there finishes first.
+    struct Collection
+    {
+      FlutterApplication *app;
+      std::shared_ptr<ExternalTexture> texture;
+    };
+    auto *collection = new Collection{this, std::move(texture)};
+    auto collect = [](void *data) -> void {
+      auto *collection = reinterpret_cast<Collection *>(data);
+      RenderDelegate &render_delegate = collection->app->render_delegate_;
+      render_delegate.OnApplicationContextMakeCurrent();
+      delete collection;
+      render_delegate.OnApplicationContextClearCurrent();
+    };
+    if (FlutterEnginePostRenderThreadTask(engine_, collect, collection) != kSuccess)
+    {
+      LogE("Could not collect an external texture on the render thread.");
+      delete collection;
+      return false;
+    }
+    return result;
+  }
+
+  bool FlutterApplication::PostRenderThreadTask(std::function<void()> task)
+  {
+    auto *pending = new std::function<void()>(std::move(task));
+    auto run = [](void *data) -> void {
+      auto *task = reinterpret_cast<std::function<void()> *>(data);
+      (*task)();
+      delete task;
+    };
+    if (FlutterEnginePostRenderThreadTask(engine_, run, pending) != kSuccess)
+    {
+      LogE("Could not post a task to the render thread.");
+      delete pending;
+      return false;
+    }
+    return true;
+  }
+
+  bool FlutterApplication::PopulateExternalTexture(int64_t texture_id, FlutterOpenGLTexture *texture_out)
+  {
+    std::shared_ptr<ExternalTexture> texture;
+    {
+      std::lock_guard<std::mutex> lock(external_textures_mutex_);
+      auto it = external_textures_.find(texture_id);
+      if (it == external_textures_.end())
+      {
+        return false;
+      }
+      texture = it->second;
+    }
+    return texture->PopulateTexture(texture_out);
+  }
+
+  bool FlutterApplication::SendLifecycleMessage(const char *state)
+  {
+    // The flutter/lifecycle channel uses the string codec.
+    FlutterPlatformMessage message = {};
+    message.struct_size = sizeof(message);
+    message.channel = "flutter/lifecycle";
+    message.message = reinterpret_cast<const uint8_t *>(state);
+    message.message_size = strlen(state);
+    return FlutterEngineSendPlatformMessage(engine_, &message) == kSuccess;
+  }
+
+  FlutterApplication::PointerState *FlutterApplication::FindPointer(bool is_mouse, int ecore_device, bool create)
+  {
+    PointerState *free_pointer = nullptr;
+    for (PointerState &pointer : pointers_)
+    {
+      if (!pointer.in_use)
+      {
+        free_pointer = free_pointer ? free_pointer : &pointer;
+      }
+      else if (pointer.is_mouse == is_mouse && pointer.ecore_device == ecore_device)
+      {
+        return &pointer;
+      }
+    }
+
+    if (!create)
+    {
+      return nullptr;
+    }
+    if (!free_pointer)
+    {
+      LogW("Too many pointers, ignoring device %d.", ecore_device);
+      return nullptr;
+    }
+    *free_pointer = {true, is_mouse, ecore_device, false, 0};
+    return free_pointer;
+  }
+
+  uint64_t FlutterApplication::ToEngineTime(unsigned int timestamp)
+  {
+    int64_t event_time = timestamp * 1000ll;
+    int64_t offset = static_cast<int64_t>(FlutterEngineGetCurrentTime() / 1000) - event_time;
+    // Events are delivered some time after they happen, so the smallest offset
+    // seen is the closest to the real one. A much larger one means the input
+    // clock has wrapped around or jumped.
+    if (!input_clock_offset_known_ || offset < input_clock_offset_ || offset > input_clock_offset_ + 1000000)
+    {
+      input_clock_offset_ = offset;
+      input_clock_offset_known_ = true;
+    }
+    return event_time + input_clock_offset_;
+  }
+
+  void FlutterApplication::SendFlutterPointerEvent(FlutterPointerPhase phase, const PointerState &pointer,
+                                                   double x, double y, uint64_t timestamp,
+                                                   double scroll_delta_x, double scroll_delta_y)
   {
     FlutterPointerEvent event = {};
     event.struct_size = sizeof(event);
     event.phase = phase;
-    event.x = x;
-    event.y = y;
+    event.device = static_cast<int32_t>(&pointer - pointers_.data());
+    event.signal_kind = kFlutterPointerSignalKindNone;
+    event.device_kind = pointer.is_mouse ? kFlutterPointerDeviceKindMouse : kFlutterPointerDeviceKindTouch;
+    event.buttons = pointer.buttons;
+    // Positions are reported in window coordinates, which have to be rotated
+    // back to those of the app.
+    double app_x = x, app_y = y;
+    switch (rotation_)
+    {
+    case 90:
+      app_x = window_height_ - y;
+      app_y = x;
+      break;
+    case 180:
+      app_x = window_width_ - x;
+      app_y = window_height_ - y;
+      break;
+    case 270:
+      app_x = y;
+      app_y = window_width_ - x;
+      break;
+    }
+    event.x = app_x * metrics_scale_;
+    event.y = app_y * metrics_scale_;
     event.timestamp = timestamp;
-    FlutterEngineSendPointerEvent(engine_, &event, 1);
+    if (scroll_delta_x != 0 || scroll_delta_y != 0)
+    {
+      double app_dx = scroll_delta_x, app_dy = scroll_delta_y;
+      switch (rotation_)
+      {
+      case 90:
+        app_dx = -scroll_delta_y;
+        app_dy = scroll_delta_x;
+        break;
+      case 180:
+        app_dx = -scroll_delta_x;
+        app_dy = -scroll_delta_y;
+        break;
+      case 270:
+        app_dx = scroll_delta_y;
+        app_dy = -scroll_delta_x;
+        break;
+      }
+      event.signal_kind = kFlutterPointerSignalKindScroll;
+      event.scroll_delta_x = app_dx * metrics_scale_;
+      event.scroll_delta_y = app_dy * metrics_scale_;
+    }
+    pointer_queue_->Push(event);
+  }
+
+  // Maps an ecore button number to the FlutterPointerMouseButtons flag.
+  static int64_t GetMouseButton(unsigned int button)
+  {
+    switch (button)
+    {
+    case 1:
+      return kFlutterPointerButtonMousePrimary;
+    case 2:
+      return kFlutterPointerButtonMouseMiddle;
+    case 3:
+      return kFlutterPointerButtonMouseSecondary;
+    case 8:
+      return kFlutterPointerButtonMouseBack;
+    case 9:
+      return kFlutterPointerButtonMouseForward;
+    default:
+      return 0;
+    }
+  }
+
+  static bool IsMouse(void *device)
+  {
+    return device && ecore_device_class_get(reinterpret_cast<const Ecore_Device *>(device)) == ECORE_DEVICE_CLASS_MOUSE;
   }
 
   Eina_Bool FlutterApplication::OnPointerEvent(void *data, int type, void *event)
   {
     auto *app = reinterpret_cast<FlutterApplication *>(data);
 
-    if (type == ECORE_EVENT_MOUSE_BUTTON_DOWN)
+    if (type == ECORE_EVENT_MOUSE_BUTTON_DOWN || type == ECORE_EVENT_MOUSE_BUTTON_UP)
     {
-      app->pointer_state_ = true;
+      auto *button_event = reinterpret_cast<Ecore_Event_Mouse_Button *>(event);
+      bool is_mouse = IsMouse(button_event->dev);
+      bool down = type == ECORE_EVENT_MOUSE_BUTTON_DOWN;
+      PointerState *pointer = app->FindPointer(is_mouse, button_event->multi.device, down);
+      if (!pointer)
+      {
+        return ECORE_CALLBACK_PASS_ON;
+      }
 
-      auto *buttonEvent = reinterpret_cast<Ecore_Event_Mouse_Button *>(event);
-      app->SendFlutterPointerEvent(kDown, buttonEvent->x, buttonEvent->y, buttonEvent->timestamp);
+      double x = button_event->x, y = button_event->y;
+      uint64_t timestamp = app->ToEngineTime(button_event->timestamp);
+      if (is_mouse)
+      {
+        // Only the first press and the last release are downs and ups, other
+        // button changes are moves.
+        if (!pointer->added)
+        {
+          app->SendFlutterPointerEvent(kAdd, *pointer, x, y, timestamp);
+          pointer->added = true;
+        }
+        int64_t buttons = pointer->buttons;
+        int64_t button = GetMouseButton(button_event->buttons);
+        pointer->buttons = down ? buttons | button : buttons & ~button;
+        if (pointer->buttons == buttons)
+        {
+          return ECORE_CALLBACK_PASS_ON;
+        }
+        FlutterPointerPhase phase = buttons == 0 && pointer->buttons != 0   ? kDown
+                                    : buttons != 0 && pointer->buttons == 0 ? kUp
+                                                                            : kMove;
+        app->SendFlutterPointerEvent(phase, *pointer, x, y, timestamp);
+      }
+      else if (down && !pointer->added)
+      {
+        app->SendFlutterPointerEvent(kAdd, *pointer, x, y, timestamp);
+        app->SendFlutterPointerEvent(kDown, *pointer, x, y, timestamp);
+        pointer->added = true;
+      }
+      else if (!down && pointer->added)
+      {
+        // A lifted finger is gone until it touches again.
+        app->SendFlutterPointerEvent(kUp, *pointer, x, y, timestamp);
+        app->SendFlutterPointerEvent(kRemove, *pointer, x, y, timestamp);
+        pointer->in_use = false;
+      }
     }
-    else if (type == ECORE_EVENT_MOUSE_BUTTON_UP)
+    else if (type == ECORE_EVENT_MOUSE_MOVE)
     {
-      app->pointer_state_ = false;
+      auto *move_event = reinterpret_cast<Ecore_Event_Mouse_Move *>(event);
+      bool is_mouse = IsMouse(move_event->dev);
+      // Mice hover, fingers only move while down.
+      PointerState *pointer = app->FindPointer(is_mouse, move_event->multi.device, is_mouse);
+      if (!pointer)
+      {
+        return ECORE_CALLBACK_PASS_ON;
+      }
 
-      auto *buttonEvent = reinterpret_cast<Ecore_Event_Mouse_Button *>(event);
-      app->SendFlutterPointerEvent(kUp, buttonEvent->x, buttonEvent->y, buttonEvent->timestamp);
+      double x = move_event->x, y = move_event->y;
+      uint64_t timestamp = app->ToEngineTime(move_event->timestamp);
+      if (is_mouse)
+      {
+        if (!pointer->added)
+        {
+          app->SendFlutterPointerEvent(kAdd, *pointer, x, y, timestamp);
+          pointer->added = true;
+        }
+        app->SendFlutterPointerEvent(pointer->buttons ? kMove : kHover, *pointer, x, y, timestamp);
+      }
+      else if (pointer->added)
+      {
+        app->SendFlutterPointerEvent(kMove, *pointer, x, y, timestamp);
+      }
     }
-    else if (type == ECORE_EVENT_MOUSE_MOVE)
+
+    return ECORE_CALLBACK_PASS_ON;
+  }
+
+  // The scroll offset in pixels of a wheel notch or a bezel detent.
+  static constexpr double kWheelScrollDelta = 20;
+  static constexpr double kDetentScrollDelta = 40;
+
+  Eina_Bool FlutterApplication::OnScrollEvent(void *data, int type, void *event)
+  {
+    auto *app = reinterpret_cast<FlutterApplication *>(data);
+
+    // Scrolls are signals of a hovering or pressed pointer, merged with those
+    // that follow in the same batch by the pointer event queue.
+    if (type == ECORE_EVENT_MOUSE_WHEEL)
     {
-      if (app->pointer_state_)
+      auto *wheel_event = reinterpret_cast<Ecore_Event_Mouse_Wheel *>(event);
+      PointerState *pointer = app->FindPointer(true, 0, true);
+      if (!pointer)
       {
-        auto *moveEvent = reinterpret_cast<Ecore_Event_Mouse_Move *>(event);
-        app->SendFlutterPointerEvent(kMove, moveEvent->x, moveEvent->y, moveEvent->timestamp);
+        return ECORE_CALLBACK_PASS_ON;
       }
+
+      double x = wheel_event->x, y = wheel_event->y;
+      uint64_t timestamp = app->ToEngineTime(wheel_event->timestamp);
+      if (!pointer->added)
+      {
+        app->SendFlutterPointerEvent(kAdd, *pointer, x, y, timestamp);
+        pointer->added = true;
+      }
+      // Direction 1 is horizontal. Positive z scrolls down or right.
+      double delta = wheel_event->z * kWheelScrollDelta;
+      app->SendFlutterPointerEvent(pointer->buttons ? kMove : kHover, *pointer, x, y, timestamp,
+                                   wheel_event->direction == 1 ? delta : 0,
+                                   wheel_event->direction == 1 ? 0 : delta);
     }
+    else if (type == ECORE_EVENT_DETENT_ROTATE)
+    {
+      auto *rotate_event = reinterpret_cast<Ecore_Event_Detent_Rotate *>(event);
+      PointerState *pointer = app->FindPointer(true, kRotaryDevice, true);
+      if (!pointer)
+      {
+        return ECORE_CALLBACK_PASS_ON;
+      }
+
+      double x = app->window_width_ / 2.0, y = app->window_height_ / 2.0;
+      uint64_t timestamp = app->ToEngineTime(rotate_event->timestamp);
+      if (!pointer->added)
+      {
+        app->SendFlutterPointerEvent(kAdd, *pointer, x, y, timestamp);
+        pointer->added = true;
+      }
+      // Clockwise scrolls down.
+      double delta = rotate_event->direction == ECORE_DETENT_DIRECTION_CLOCKWISE ? kDetentScrollDelta
+                                                                                : -kDetentScrollDelta;
+      app->SendFlutterPointerEvent(kHover, *pointer, x, y, timestamp, 0, delta);
+    }
+
+    return ECORE_CALLBACK_PASS_ON;
+  }
+
+  Eina_Bool FlutterApplication::OnHeldFrameTimer(void *data)
+  {
+    auto *app = reinterpret_cast<FlutterApplication *>(data);
+    app->held_frame_timer_ = nullptr;
+    app->PostRenderThreadTask([app]() {
+      if (!app->render_delegate_.OnApplicationPresentHeldFrame())
+      {
+        char wakeup = 0;
+        ecore_pipe_write(app->held_frame_pipe_, &wakeup, sizeof(wakeup));
+      }
+    });
+    return ECORE_CALLBACK_CANCEL;
+  }
 
+  Eina_Bool FlutterApplication::OnKeyEvent(void *data, int type, void *event)
+  {
+    auto *app = reinterpret_cast<FlutterApplication *>(data);
+    app->key_event_channel_->SendKeyEvent(reinterpret_cast<Ecore_Event_Key *>(event), type == ECORE_EVENT_KEY_DOWN);
     return ECORE_CALLBACK_PASS_ON;
   }
 
+  void FlutterApplication::OnUnhandledKeyEvent(const KeyEventChannel::KeyEvent &event)
+  {
+    if (event.is_down)
+    {
+      text_input_channel_->OnKeyDown(event.key, event.string, event.modifiers);
+    }
+    else if (strcmp(event.key, "XF86Back") == 0)
+    {
+      // The back key pops the route unless the app has taken it.
+      static constexpr char kPopRoute[] = "{\"method\":\"popRoute\",\"args\":null}";
+      FlutterPlatformMessage message = {};
+      message.struct_size = sizeof(message);
+      message.channel = "flutter/navigation";
+      message.message = reinterpret_cast<const uint8_t *>(kPopRoute);
+      message.message_size = sizeof(kPopRoute) - 1;
+      FlutterEngineSendPlatformMessage(engine_, &message);
+    }
+  }
+
+  void FlutterApplication::OnPlatformMessage(const FlutterPlatformMessage *message)
+  {
+    if (text_input_channel_ && strcmp(message->channel, "flutter/textinput") == 0)
+    {
+      text_input_channel_->HandleMessage(*message);
+      return;
+    }
+    // Every message needs a response, an empty one for unknown channels.
+    FlutterEngineSendPlatformMessageResponse(engine_, message->response_handle, nullptr, 0);
+  }
+
   FlutterApplication::~FlutterApplication()
   {
     for (auto handler : pointer_event_handlers_)
@@ -146,6 +769,20 @@ namespace flutter
       ecore_event_handler_del(handler);
     }
     pointer_event_handlers_.clear();
+    for (auto handler : key_event_handlers_)
+    {
+      ecore_event_handler_del(handler);
+    }
+    key_event_handlers_.clear();
+    if (held_frame_timer_)
+    {
+      ecore_timer_del(held_frame_timer_);
+      held_frame_timer_ = nullptr;
+    }
+
+    // Pending events are dropped along with the engine.
+    vsync_waiter_->SetObserver(nullptr);
+    pointer_queue_.reset();
 
     if (engine_)
     {
@@ -155,6 +792,21 @@ namespace flutter
         LogE("Could not shutdown the Flutter engine.");
       }
     }
+    // Key event responses still pending are never delivered.
+    key_event_channel_.reset();
+    text_input_channel_.reset();
+
+    // Written by the render thread, which the engine has stopped by now.
+    if (held_frame_pipe_)
+    {
+      ecore_pipe_del(held_frame_pipe_);
+      held_frame_pipe_ = nullptr;
+    }
+    if (metrics_pipe_)
+    {
+      ecore_pipe_del(metrics_pipe_);
+      metrics_pipe_ = nullptr;
+    }
   }
 
 } // namespace flutter
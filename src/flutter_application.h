@@ -5,26 +5,69 @@
 #pragma once
 
 #include <flutter_embedder.h>
+#include <array>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #define EFL_BETA_API_SUPPORT
+#include <Ecore.h>
 #include <Ecore_Wl2.h>
 #include <Ecore_Input.h>
 
+#include "flutter_tizen.h"
+#include "key_event_channel.h"
+#include "platform_task_runner.h"
+#include "pointer_event_queue.h"
+#include "render_scale_controller.h"
+#include "render_task_runner.h"
+#include "text_input_channel.h"
 #include "vsync_waiter.h"
 
 namespace flutter
 {
+  class ExternalTexture;
+
   class FlutterApplication
   {
   public:
     class RenderDelegate
     {
     public:
+      // kOpenGL or kSoftware. Only the callbacks of that renderer are used.
+      virtual FlutterRendererType GetRendererType() const = 0;
+      // Returns false if the frame could not be presented right away. It may
+      // then be held back, and presented by OnApplicationPresentHeldFrame().
+      virtual bool OnApplicationPresentSoftware(const void *allocation, size_t row_bytes, size_t height) = 0;
+      // Returns false while a software frame is still held back. Called on the
+      // render thread.
+      virtual bool OnApplicationPresentHeldFrame() = 0;
       virtual bool OnApplicationContextMakeCurrent() = 0;
       virtual bool OnApplicationContextMakeResourceCurrent() = 0;
       virtual bool OnApplicationContextClearCurrent() = 0;
       virtual bool OnApplicationPresent() = 0;
+      // Sets the region, in surface pixels with a top-left origin, that the
+      // next presented frame changes, and returns the region of the back buffer
+      // that has to be redrawn given its age. Must be called on the render
+      // thread with the onscreen context current.
+      virtual FlutterRect OnApplicationSetFrameDamage(const FlutterRect &damage) = 0;
+      virtual bool OnApplicationCreateBackingStore(const FlutterBackingStoreConfig &config,
+                                                   FlutterBackingStore *backing_store_out) = 0;
+      virtual bool OnApplicationCollectBackingStore(const FlutterBackingStore &backing_store) = 0;
+      virtual bool OnApplicationPresentLayers(const FlutterLayer **layers, size_t layers_count) = 0;
+      // Called instead of presenting when a frame is dropped, so that the next
+      // frame does not rely on what the dropped one would have shown.
+      virtual void OnApplicationFrameDropped() = 0;
+      // Rotates the window buffer clockwise by |degrees| for the frames that
+      // follow. Called on the render thread between two frames.
+      virtual void OnApplicationSetBufferRotation(int32_t degrees) = 0;
+      // Wraps an external buffer in an EGLImage without copying it. Called on
+      // the render thread.
+      virtual void *OnApplicationCreateExternalImage(const FlutterDesktopExternalBuffer &buffer) = 0;
+      // Can be called on any thread.
+      virtual void OnApplicationDestroyExternalImage(void *image) = 0;
       virtual uint32_t OnApplicationGetOnscreenFBO() = 0;
       virtual void *GetProcAddress(const char *) = 0;
     };
@@ -32,23 +75,128 @@ namespace flutter
     FlutterApplication(std::string bundle_path,
                        std::string icu_data_path,
                        const std::vector<const char*> &args,
+                       std::unique_ptr<VsyncWaiter> vsync_waiter,
+                       std::unique_ptr<RenderTaskRunner> render_task_runner,
+                       // Null to always render at the window size.
+                       std::unique_ptr<RenderScaleController> render_scale,
+                       FlutterDesktopPointerBatching pointer_batching,
+                       // Null to send touch moves as they are reported.
+                       std::unique_ptr<PointerResampler> touch_resampler,
                        RenderDelegate &render_delegate);
     virtual ~FlutterApplication();
     bool IsValid() const;
     bool SetWindowSize(size_t width, size_t height);
+    // Rotates the content clockwise by |degrees|, a multiple of 90, within a
+    // window of the same size. The engine renders rotated into the window
+    // buffer, and the layout only changes if the aspect ratio does.
+    bool SetRotation(int32_t degrees);
+
+    // Lifecycle notifications from the host. While paused, no vsync is
+    // requested from the display and rendered frames are not presented.
+    bool Resume();
+    bool Inactivate();
+    bool Pause();
+
+    std::shared_ptr<ExternalTexture> RegisterExternalTexture();
+    bool MarkExternalTextureFrameAvailable(int64_t texture_id);
+    // The texture is destroyed on the render thread once the engine no longer
+    // uses it.
+    bool UnregisterExternalTexture(std::shared_ptr<ExternalTexture> texture);
+
+    // Runs |task| on the render thread, between frames.
+    bool PostRenderThreadTask(std::function<void()> task);
 
   private:
     bool valid_;
     RenderDelegate &render_delegate_;
     FlutterEngine engine_ = nullptr;
 
+    std::unique_ptr<PlatformTaskRunner> platform_task_runner_;
+    std::unique_ptr<RenderTaskRunner> render_task_runner_;
+
     std::unique_ptr<VsyncWaiter> vsync_waiter_;
+    std::unique_ptr<RenderScaleController> render_scale_;
+    // Read on the render thread.
+    std::atomic<bool> presentation_suspended_{false};
+
+    std::mutex external_textures_mutex_;
+    std::unordered_map<int64_t, std::shared_ptr<ExternalTexture>> external_textures_;
+    int64_t next_external_texture_id_ = 1;
 
+    size_t window_width_ = 0;
+    size_t window_height_ = 0;
+    // The render scale of the last window metrics sent, by which pointer
+    // positions are scaled. Only accessed on the platform thread.
+    double metrics_scale_ = 1.0;
+    FlutterWindowMetricsEvent last_metrics_ = {};
+    // The rotation of the content on the platform thread, which the render
+    // thread follows with |surface_rotation_| once the buffer is rotated.
+    int32_t rotation_ = 0;
+    // Read on the render thread to build the surface transformation. The frame
+    // size is that of the window buffer at the current render scale.
+    std::atomic<int32_t> surface_rotation_{0};
+    std::atomic<double> frame_width_{0};
+    std::atomic<double> frame_height_{0};
+    // Wakes the platform thread up when the render scale changes.
+    Ecore_Pipe *metrics_pipe_ = nullptr;
+    // Wakes the platform thread up when a software frame has been held back,
+    // which then retries presenting it after |kHeldFrameRetryInterval|.
+    static constexpr double kHeldFrameRetryInterval = 1.0 / 240;
+    Ecore_Pipe *held_frame_pipe_ = nullptr;
+    Ecore_Timer *held_frame_timer_ = nullptr;
+
+    // The state of a touch point or mouse known to the engine. The index of
+    // the entry is the device id reported to the engine, so it is unique
+    // among the pointers in use.
+    struct PointerState
+    {
+      bool in_use;
+      bool is_mouse;
+      int ecore_device;
+      // Whether kAdd has been sent. Touches are added as they go down and
+      // removed as they go up.
+      bool added;
+      // For mice, the FlutterPointerMouseButtons pressed.
+      int64_t buttons;
+    };
+    // Touches beyond this are ignored.
+    static constexpr size_t kMaxPointers = 10;
+    // The ecore device of the pointer that rotary (bezel) scrolls come from.
+    // It stays at the center of the window.
+    static constexpr int kRotaryDevice = -1;
+
+    std::unique_ptr<PointerEventQueue> pointer_queue_;
     std::vector<Ecore_Event_Handler *> pointer_event_handlers_;
-    bool pointer_state_ = false;
+    std::array<PointerState, kMaxPointers> pointers_ = {};
+    // The difference in microseconds between the engine clock and that of the
+    // input events, whose origin is unknown.
+    int64_t input_clock_offset_ = 0;
+    bool input_clock_offset_known_ = false;
+
+    std::unique_ptr<KeyEventChannel> key_event_channel_;
+    std::unique_ptr<TextInputChannel> text_input_channel_;
+    std::vector<Ecore_Event_Handler *> key_event_handlers_;
 
-    void SendFlutterPointerEvent(FlutterPointerPhase phase, double x, double y, size_t timestamp);
+    // Unchanged metrics are only sent if |force| is set.
+    bool SendWindowMetrics(bool force = false);
+    FlutterTransformation GetSurfaceTransformation() const;
+    bool SendLifecycleMessage(const char *state);
+    bool PopulateExternalTexture(int64_t texture_id, FlutterOpenGLTexture *texture_out);
+    PointerState *FindPointer(bool is_mouse, int ecore_device, bool create);
+    // Converts an input event timestamp in milliseconds to the engine clock in
+    // microseconds.
+    uint64_t ToEngineTime(unsigned int timestamp);
+    // Sends a scroll signal instead if either delta is non-zero. Positions and
+    // deltas are in window coordinates.
+    void SendFlutterPointerEvent(FlutterPointerPhase phase, const PointerState &pointer, double x, double y,
+                                 uint64_t timestamp, double scroll_delta_x = 0, double scroll_delta_y = 0);
     static Eina_Bool OnPointerEvent(void *data, int type, void *event);
+    static Eina_Bool OnScrollEvent(void *data, int type, void *event);
+    static Eina_Bool OnHeldFrameTimer(void *data);
+    static Eina_Bool OnKeyEvent(void *data, int type, void *event);
+    // Called with the key events the framework did not handle.
+    void OnUnhandledKeyEvent(const KeyEventChannel::KeyEvent &event);
+    void OnPlatformMessage(const FlutterPlatformMessage *message);
 
     // Disallow copy and assign operations.
     FlutterApplication(const FlutterApplication &) = delete;
@@ -15,16 +15,124 @@
  */
 
 #include "flutter_tizen.h"
+
+#include <future>
+
+#include "external_texture.h"
 #include "flutter_application.h"
+#include "offscreen_display.h"
+#include "pointer_resampler.h"
+#include "render_scale_controller.h"
+#include "render_task_runner.h"
 #include "tizen_display.h"
+#include "vsync_source.h"
 #include "logger.h"
 
 struct FlutterApplicationState
 {
+  // Only one of the displays is used.
   std::unique_ptr<flutter::TizenDisplay> display;
+  std::unique_ptr<flutter::OffscreenDisplay> offscreen_display;
   std::unique_ptr<flutter::FlutterApplication> application;
+  Ecore_Event_Handler *rotation_event_handler = nullptr;
+};
+
+struct FlutterDesktopExternalTextureState
+{
+  std::shared_ptr<flutter::ExternalTexture> texture;
 };
 
+static bool StartFlutterApplication(FlutterApplicationState *state,
+                                    flutter::FlutterApplication::RenderDelegate &render_delegate,
+                                    size_t width,
+                                    size_t height,
+                                    std::unique_ptr<VsyncSource> vsync_source,
+                                    std::unique_ptr<flutter::RenderScaleController> render_scale,
+                                    const FlutterDesktopEngineProperties &engine_properties,
+                                    const char **switches,
+                                    size_t switches_count)
+{
+  std::vector<const char*> args;
+  for (size_t i = 0; i < switches_count; i++)
+  {
+    args.push_back(switches[i]);
+  }
+
+  auto vsync_waiter = std::make_unique<VsyncWaiter>(std::move(vsync_source),
+                                                    engine_properties.vsync_phase_offset * 1000ll,
+                                                    engine_properties.vsync_adaptive_phase);
+
+  auto render_task_runner = std::make_unique<flutter::RenderTaskRunner>(
+      engine_properties.render_thread_name ? engine_properties.render_thread_name : "flutter-raster",
+      engine_properties.render_thread_priority,
+      engine_properties.render_thread_nice,
+      engine_properties.render_thread_cpu_mask);
+  if (!render_task_runner->IsValid())
+  {
+    LogE("Could not create the render task runner.");
+    return false;
+  }
+
+  std::unique_ptr<flutter::PointerResampler> touch_resampler;
+  if (engine_properties.pointer_batching == kFlutterDesktopPointerBatchingVsync &&
+      engine_properties.touch_resampling)
+  {
+    touch_resampler = std::make_unique<flutter::PointerResampler>(engine_properties.touch_prediction);
+  }
+
+  state->application = std::make_unique<flutter::FlutterApplication>(
+      engine_properties.assets_path,
+      engine_properties.icu_data_path,
+      args,
+      std::move(vsync_waiter),
+      std::move(render_task_runner),
+      std::move(render_scale),
+      engine_properties.pointer_batching,
+      std::move(touch_resampler),
+      render_delegate);
+
+  if (!state->application->IsValid())
+  {
+    LogE("Could not initialize the Flutter application.");
+    return false;
+  }
+
+  if (!state->application->SetWindowSize(width, height))
+  {
+    LogE("Could not update the Flutter application size.");
+    return false;
+  }
+
+  return true;
+}
+
+static bool RotateFlutterApplication(FlutterApplicationState *state, int32_t degrees, bool server_request)
+{
+  degrees = ((degrees % 360) + 360) % 360;
+  if (degrees % 90 != 0)
+  {
+    LogE("Cannot rotate by %d degrees.", degrees);
+    return false;
+  }
+  // The display server first. The application then rotates the buffer on the
+  // render thread before the first rotated frame.
+  return state->display->SetRotation(degrees, server_request) &&
+         state->application->SetRotation(degrees);
+}
+
+static Eina_Bool OnWindowRotate(void *data, int type, void *event)
+{
+  auto *state = reinterpret_cast<FlutterApplicationState *>(data);
+  auto *rotation_event = reinterpret_cast<Ecore_Wl2_Event_Window_Rotation *>(event);
+  if (rotation_event->win == state->display->GetWindowId() &&
+      !RotateFlutterApplication(state, rotation_event->rotation, true))
+  {
+    // The window stays mid-rotation until the request is answered.
+    state->display->RejectRotationRequest();
+  }
+  return ECORE_CALLBACK_PASS_ON;
+}
+
 FLUTTER_EXPORT FlutterApplicationRef RunFlutterApplication(
     const FlutterDesktopSize &size,
     const FlutterDesktopEngineProperties &engine_properties,
@@ -33,54 +141,248 @@ FLUTTER_EXPORT FlutterApplicationRef RunFlutterApplication(
 {
   auto state = std::make_unique<FlutterApplicationState>();
 
-  state->display = std::make_unique<flutter::TizenDisplay>(size.width, size.height);
+  flutter::SurfaceConfig surface_config;
+  surface_config.format = engine_properties.surface_format;
+  surface_config.depth_bits = engine_properties.surface_depth_bits;
+  surface_config.stencil_bits = engine_properties.surface_stencil_bits;
+
+  state->display = std::make_unique<flutter::TizenDisplay>(size.width, size.height,
+                                                           engine_properties.renderer,
+                                                           engine_properties.software_pixel_format,
+                                                           surface_config);
   if (!state->display->IsValid())
   {
     LogE("Could not initialize the display.");
     return nullptr;
   }
 
-  std::vector<const char*> args;
-  for (size_t i = 0; i < switches_count; i++)
+  auto vsync_source = VsyncSource::Create(engine_properties.vsync_source,
+                                          state->display->GetWaylandDisplay(),
+                                          state->display->GetWaylandSurface(),
+                                          engine_properties.vsync_timer_rate);
+
+  // The software renderer presents the frame as it is, at the window size.
+  std::unique_ptr<flutter::RenderScaleController> render_scale;
+  if (engine_properties.renderer == kFlutterDesktopRendererOpenGL &&
+      engine_properties.render_scale_min > 0 && engine_properties.render_scale_min < 1)
   {
-    args.push_back(switches[i]);
+    int32_t frame_budget = engine_properties.render_scale_frame_budget > 0
+                               ? engine_properties.render_scale_frame_budget
+                               : 13000;
+    render_scale = std::make_unique<flutter::RenderScaleController>(engine_properties.render_scale_min,
+                                                                     frame_budget * 1000ull);
   }
 
-  state->application = std::make_unique<flutter::FlutterApplication>(
-      engine_properties.assets_path,
-      engine_properties.icu_data_path,
-      args,
-      *state->display);
+  if (!StartFlutterApplication(state.get(), *state->display,
+                               state->display->GetWidth(), state->display->GetHeight(),
+                               std::move(vsync_source), std::move(render_scale),
+                               engine_properties, switches, switches_count))
+  {
+    return nullptr;
+  }
 
-  if (!state->application->IsValid())
+  // Only sent once rotations are made available to the window manager.
+  state->rotation_event_handler = ecore_event_handler_add(ECORE_WL2_EVENT_WINDOW_ROTATE, OnWindowRotate, state.get());
+
+  return state.release();
+}
+
+FLUTTER_EXPORT FlutterApplicationRef RunFlutterApplicationOffscreen(
+    const FlutterDesktopSize &size,
+    const FlutterDesktopEngineProperties &engine_properties,
+    const FlutterDesktopOffscreenTarget &target,
+    const char **switches,
+    size_t switches_count)
+{
+  auto state = std::make_unique<FlutterApplicationState>();
+
+  state->offscreen_display = std::make_unique<flutter::OffscreenDisplay>(size.width, size.height, target);
+  if (!state->offscreen_display->IsValid())
   {
-    LogE("Could not initialize the Flutter application.");
+    LogE("Could not initialize the offscreen display.");
     return nullptr;
   }
 
-  if (!state->application->SetWindowSize(state->display->GetWidth(), state->display->GetHeight()))
+  // There is no display to synchronize with.
+  auto vsync_source = VsyncSource::Create(kFlutterDesktopVsyncSourceTimer, nullptr, nullptr,
+                                          engine_properties.vsync_timer_rate);
+
+  if (!StartFlutterApplication(state.get(), *state->offscreen_display,
+                               state->offscreen_display->GetWidth(), state->offscreen_display->GetHeight(),
+                               std::move(vsync_source), nullptr, engine_properties, switches, switches_count))
   {
-    LogE("Could not update the Flutter application size.");
     return nullptr;
   }
 
   return state.release();
 }
 
+FLUTTER_EXPORT bool FlushFlutterApplicationOffscreenFrames(FlutterApplicationRef application)
+{
+  if (!application || !application->application || !application->offscreen_display)
+    return false;
+
+  // Set by the task, or abandoned if the task is dropped without running.
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> flushed = done->get_future();
+  flutter::OffscreenDisplay *display = application->offscreen_display.get();
+  if (!application->application->PostRenderThreadTask([display, done]() {
+        display->FlushFrames();
+        done->set_value();
+      }))
+  {
+    return false;
+  }
+  flushed.wait();
+  return true;
+}
+
 FLUTTER_EXPORT bool StopFlutterApplication(FlutterApplicationRef application)
 {
   if (!application)
     return false;
 
-  if (application->display)
+  if (application->rotation_event_handler)
   {
-    application->display.reset();
+    ecore_event_handler_del(application->rotation_event_handler);
   }
+
+  // The engine renders until it is shut down, so the display must outlive it.
   if (application->application)
   {
     application->application.reset();
   }
+  if (application->display)
+  {
+    application->display.reset();
+  }
+  if (application->offscreen_display)
+  {
+    application->offscreen_display.reset();
+  }
   delete application;
 
   return true;
 }
+
+FLUTTER_EXPORT bool ResumeFlutterApplication(FlutterApplicationRef application)
+{
+  if (!application || !application->application)
+    return false;
+
+  return application->application->Resume();
+}
+
+FLUTTER_EXPORT bool InactivateFlutterApplication(FlutterApplicationRef application)
+{
+  if (!application || !application->application)
+    return false;
+
+  return application->application->Inactivate();
+}
+
+FLUTTER_EXPORT bool PauseFlutterApplication(FlutterApplicationRef application)
+{
+  if (!application || !application->application)
+    return false;
+
+  return application->application->Pause();
+}
+
+FLUTTER_EXPORT bool SetFlutterApplicationRotation(FlutterApplicationRef application, int32_t degrees)
+{
+  if (!application || !application->display || !application->application)
+    return false;
+
+  return RotateFlutterApplication(application, degrees, false);
+}
+
+FLUTTER_EXPORT bool SetFlutterApplicationAvailableRotations(FlutterApplicationRef application,
+                                                            const int32_t *degrees,
+                                                            size_t count)
+{
+  if (!application || !application->display || (!degrees && count > 0))
+    return false;
+
+  return application->display->SetAvailableRotations(degrees, count);
+}
+
+FLUTTER_EXPORT bool GetFlutterApplicationRenderStats(FlutterApplicationRef application,
+                                                     FlutterDesktopRenderStats *stats)
+{
+  if (!application || !stats)
+    return false;
+
+  if (application->display)
+  {
+    application->display->GetRenderStats(stats);
+    return true;
+  }
+  if (application->offscreen_display)
+  {
+    *stats = {};
+    application->offscreen_display->GetRenderStats(stats);
+    return true;
+  }
+  return false;
+}
+
+FLUTTER_EXPORT wl_surface *CreateFlutterPlatformViewSurface(FlutterApplicationRef application,
+                                                            int64_t view_id)
+{
+  if (!application || !application->display)
+    return nullptr;
+
+  return application->display->CreatePlatformViewSurface(view_id);
+}
+
+FLUTTER_EXPORT bool DestroyFlutterPlatformViewSurface(FlutterApplicationRef application,
+                                                      int64_t view_id)
+{
+  if (!application || !application->display)
+    return false;
+
+  return application->display->DestroyPlatformViewSurface(view_id);
+}
+
+FLUTTER_EXPORT FlutterDesktopExternalTextureRef RegisterFlutterExternalTexture(FlutterApplicationRef application)
+{
+  if (!application || !application->application)
+    return nullptr;
+
+  auto texture = application->application->RegisterExternalTexture();
+  if (!texture)
+    return nullptr;
+
+  return new FlutterDesktopExternalTextureState{std::move(texture)};
+}
+
+FLUTTER_EXPORT int64_t GetFlutterExternalTextureId(FlutterDesktopExternalTextureRef texture)
+{
+  if (!texture)
+    return -1;
+
+  return texture->texture->GetId();
+}
+
+FLUTTER_EXPORT bool PushFlutterExternalTextureBuffer(FlutterApplicationRef application,
+                                                     FlutterDesktopExternalTextureRef texture,
+                                                     const FlutterDesktopExternalBuffer *buffer)
+{
+  if (!application || !application->application || !texture || !buffer)
+    return false;
+
+  texture->texture->PushBuffer(*buffer);
+  return application->application->MarkExternalTextureFrameAvailable(texture->texture->GetId());
+}
+
+FLUTTER_EXPORT bool UnregisterFlutterExternalTexture(FlutterApplicationRef application,
+                                                     FlutterDesktopExternalTextureRef texture)
+{
+  if (!application || !application->application || !texture)
+    return false;
+
+  bool result = application->application->UnregisterExternalTexture(std::move(texture->texture));
+  delete texture;
+  return result;
+}
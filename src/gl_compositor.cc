@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "gl_compositor.h"
+
+#include <GLES2/gl2ext.h>
+#include <algorithm>
+#include <cmath>
+
+#include "logger.h"
+
+namespace flutter
+{
+  // Keep about three full-screen layers around once they are released.
+  static constexpr size_t kMaxPooledSurfaces = 3;
+
+  static const char *kVertexShader =
+      "attribute vec2 a_position;\n"
+      "attribute vec2 a_texcoord;\n"
+      "varying vec2 v_texcoord;\n"
+      "void main() {\n"
+      "  gl_Position = vec4(a_position, 0.0, 1.0);\n"
+      "  v_texcoord = a_texcoord;\n"
+      "}\n";
+
+  static const char *kFragmentShader =
+      "precision mediump float;\n"
+      "uniform sampler2D u_texture;\n"
+      "varying vec2 v_texcoord;\n"
+      "void main() {\n"
+      "  gl_FragColor = texture2D(u_texture, v_texcoord);\n"
+      "}\n";
+
+  static GLuint CompileShader(GLenum type, const char *source)
+  {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled != GL_TRUE)
+    {
+      char log[512] = {};
+      glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+      LogE("Could not compile the compositor shader: %s", log);
+      glDeleteShader(shader);
+      return 0;
+    }
+    return shader;
+  }
+
+  static FlutterRect GetLayerRect(const FlutterLayer &layer)
+  {
+    return {layer.offset.x, layer.offset.y, layer.offset.x + layer.size.width, layer.offset.y + layer.size.height};
+  }
+
+  static FlutterRect ScaleRect(const FlutterRect &rect, double scale)
+  {
+    return {rect.left * scale, rect.top * scale, rect.right * scale, rect.bottom * scale};
+  }
+
+  static bool EqualRects(const FlutterRect &a, const FlutterRect &b)
+  {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+  }
+
+  static FlutterRect IntersectRects(const FlutterRect &a, const FlutterRect &b)
+  {
+    FlutterRect rect = {std::max(a.left, b.left), std::max(a.top, b.top),
+                        std::min(a.right, b.right), std::min(a.bottom, b.bottom)};
+    rect.right = std::max(rect.right, rect.left);
+    rect.bottom = std::max(rect.bottom, rect.top);
+    return rect;
+  }
+
+  static FlutterTransformation ConcatTransformations(const FlutterTransformation &a, const FlutterTransformation &b)
+  {
+    return {a.scaleX * b.scaleX + a.skewX * b.skewY + a.transX * b.pers0,
+            a.scaleX * b.skewX + a.skewX * b.scaleY + a.transX * b.pers1,
+            a.scaleX * b.transX + a.skewX * b.transY + a.transX * b.pers2,
+            a.skewY * b.scaleX + a.scaleY * b.skewY + a.transY * b.pers0,
+            a.skewY * b.skewX + a.scaleY * b.scaleY + a.transY * b.pers1,
+            a.skewY * b.transX + a.scaleY * b.transY + a.transY * b.pers2,
+            a.pers0 * b.scaleX + a.pers1 * b.skewY + a.pers2 * b.pers0,
+            a.pers0 * b.skewX + a.pers1 * b.scaleY + a.pers2 * b.pers1,
+            a.pers0 * b.transX + a.pers1 * b.transY + a.pers2 * b.pers2};
+  }
+
+  // Returns the bounds of |rect| mapped through |transformation|.
+  static FlutterRect MapRect(const FlutterTransformation &t, const FlutterRect &rect)
+  {
+    const double xs[] = {rect.left, rect.right, rect.left, rect.right};
+    const double ys[] = {rect.top, rect.top, rect.bottom, rect.bottom};
+
+    FlutterRect bounds = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for (int i = 0; i < 4; i++)
+    {
+      double w = t.pers0 * xs[i] + t.pers1 * ys[i] + t.pers2;
+      if (w == 0)
+      {
+        w = 1;
+      }
+      double x = (t.scaleX * xs[i] + t.skewX * ys[i] + t.transX) / w;
+      double y = (t.skewY * xs[i] + t.scaleY * ys[i] + t.transY) / w;
+      bounds = {std::min(bounds.left, x), std::min(bounds.top, y), std::max(bounds.right, x), std::max(bounds.bottom, y)};
+    }
+    return bounds;
+  }
+
+  GLCompositor::GLCompositor(int32_t surface_width, int32_t surface_height)
+      : surface_width_(surface_width),
+        surface_height_(surface_height),
+        pool_(kMaxPooledSurfaces * surface_width * surface_height * 4)
+  {
+    last_layer_geometry_.reserve(8);
+  }
+
+  GLCompositor::~GLCompositor()
+  {
+    if (program_)
+    {
+      glDeleteProgram(program_);
+      program_ = 0;
+    }
+  }
+
+  bool GLCompositor::CreateBackingStore(const FlutterBackingStoreConfig &config, FlutterBackingStore *backing_store_out)
+  {
+    auto width = static_cast<int32_t>(std::ceil(config.size.width));
+    auto height = static_cast<int32_t>(std::ceil(config.size.height));
+
+    BackingStorePool::Entry *entry = pool_.Acquire(width, height);
+    if (!entry)
+    {
+      return false;
+    }
+
+    backing_store_out->type = kFlutterBackingStoreTypeOpenGL;
+    backing_store_out->user_data = entry;
+    backing_store_out->open_gl.type = kFlutterOpenGLTargetTypeFramebuffer;
+    // The engine reads the color format of the framebuffer from |target|.
+    backing_store_out->open_gl.framebuffer.target = GL_RGBA8_OES;
+    backing_store_out->open_gl.framebuffer.name = entry->framebuffer;
+    backing_store_out->open_gl.framebuffer.user_data = entry;
+    // The entry goes back to the pool in CollectBackingStore().
+    backing_store_out->open_gl.framebuffer.destruction_callback = [](void *) {};
+    return true;
+  }
+
+  bool GLCompositor::CollectBackingStore(const FlutterBackingStore &backing_store)
+  {
+    pool_.Release(reinterpret_cast<BackingStorePool::Entry *>(backing_store.user_data));
+    return true;
+  }
+
+  FlutterRect GLCompositor::ComputeDamage(const FlutterLayer **layers, size_t layers_count)
+  {
+    // The first layer is the root surface of the frame, which the engine sizes
+    // after the window metrics it had when the frame started.
+    double content_scale = content_scale_;
+    if (layers_count > 0 && layers[0]->type == kFlutterLayerContentTypeBackingStore && surface_width_ > 0)
+    {
+      content_scale = layers[0]->size.width / surface_width_;
+    }
+    bool geometry_changed = layers_count != last_layer_geometry_.size() || content_scale != content_scale_;
+    content_scale_ = content_scale;
+    FlutterRect damage = {0, 0, 0, 0};
+    bool damaged = false;
+
+    for (size_t i = 0; i < layers_count; i++)
+    {
+      const FlutterLayer &layer = *layers[i];
+      LayerGeometry geometry = GetLayerGeometry(layer);
+      FlutterRect rect = geometry.rect;
+
+      if (!geometry_changed && (!EqualRects(rect, last_layer_geometry_[i].rect) ||
+                                geometry.opacity != last_layer_geometry_[i].opacity))
+      {
+        geometry_changed = true;
+      }
+
+      if (layer.type == kFlutterLayerContentTypeBackingStore && layer.backing_store->did_update)
+      {
+        damage = damaged ? FlutterRect{std::min(damage.left, rect.left), std::min(damage.top, rect.top),
+                                       std::max(damage.right, rect.right), std::max(damage.bottom, rect.bottom)}
+                         : rect;
+        damaged = true;
+      }
+    }
+
+    last_layer_geometry_.resize(layers_count);
+    for (size_t i = 0; i < layers_count; i++)
+    {
+      last_layer_geometry_[i] = GetLayerGeometry(*layers[i]);
+    }
+
+    return geometry_changed ? GetSurfaceRect() : damage;
+  }
+
+  bool GLCompositor::DrawLayers(const FlutterLayer **layers, size_t layers_count, const FlutterRect &repaint_rect,
+                                GLuint framebuffer)
+  {
+    if (!EnsureProgram())
+    {
+      return false;
+    }
+
+    // Scissor rects have a bottom-left origin.
+    GLint left = static_cast<GLint>(std::floor(repaint_rect.left));
+    GLint top = static_cast<GLint>(std::floor(repaint_rect.top));
+    GLint right = static_cast<GLint>(std::ceil(repaint_rect.right));
+    GLint bottom = static_cast<GLint>(std::ceil(repaint_rect.bottom));
+    if (right <= left || bottom <= top)
+    {
+      return true;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, surface_width_, surface_height_);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(left, surface_height_ - bottom, right - left, bottom - top);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glUseProgram(program_);
+    glUniform1i(texture_location_, 0);
+    glActiveTexture(GL_TEXTURE0);
+    // Layer contents are premultiplied.
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    for (size_t i = 0; i < layers_count; i++)
+    {
+      const FlutterLayer &layer = *layers[i];
+      if (layer.type == kFlutterLayerContentTypePlatformView)
+      {
+        // Fade out what was drawn so far by the opacity of the view, so that
+        // the subsurface below shows through in its place.
+        LayerGeometry geometry = GetLayerGeometry(layer);
+        glBlendFunc(GL_ZERO, GL_ONE_MINUS_CONSTANT_ALPHA);
+        glBlendColor(0, 0, 0, static_cast<GLfloat>(geometry.opacity));
+        DrawTexture(0, geometry.rect, 0, 0);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        continue;
+      }
+
+      auto *entry = reinterpret_cast<BackingStorePool::Entry *>(layer.backing_store->user_data);
+      DrawTexture(entry->texture, GetLayerGeometry(layer).rect,
+                  static_cast<float>(entry->content_width) / entry->width,
+                  static_cast<float>(entry->content_height) / entry->height);
+    }
+
+    glDisable(GL_BLEND);
+    glDisable(GL_SCISSOR_TEST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    return true;
+  }
+
+  void GLCompositor::EndFrame() { pool_.Trim(); }
+
+  void GLCompositor::Invalidate() { last_layer_geometry_.clear(); }
+
+  void GLCompositor::GetRenderStats(FlutterDesktopRenderStats *stats) const
+  {
+    stats->backing_store_bytes = pool_.GetAllocatedBytes();
+    stats->backing_store_pooled_bytes = pool_.GetPooledBytes();
+    stats->backing_store_allocation_count = pool_.GetAllocationCount();
+  }
+
+  double GLCompositor::GetContentScale() const { return content_scale_; }
+
+  bool GLCompositor::EnsureProgram()
+  {
+    if (program_)
+    {
+      return true;
+    }
+
+    GLuint vertex_shader = CompileShader(GL_VERTEX_SHADER, kVertexShader);
+    GLuint fragment_shader = CompileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+    if (!vertex_shader || !fragment_shader)
+    {
+      glDeleteShader(vertex_shader);
+      glDeleteShader(fragment_shader);
+      return false;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+      LogE("Could not link the compositor program.");
+      glDeleteProgram(program);
+      return false;
+    }
+
+    program_ = program;
+    position_location_ = glGetAttribLocation(program_, "a_position");
+    texcoord_location_ = glGetAttribLocation(program_, "a_texcoord");
+    texture_location_ = glGetUniformLocation(program_, "u_texture");
+    return true;
+  }
+
+  FlutterRect GLCompositor::GetSurfaceRect() const
+  {
+    return {0, 0, static_cast<double>(surface_width_), static_cast<double>(surface_height_)};
+  }
+
+  GLCompositor::LayerGeometry GLCompositor::GetLayerGeometry(const FlutterLayer &layer) const
+  {
+    LayerGeometry geometry = {GetLayerRect(layer), 1.0};
+    if (layer.type != kFlutterLayerContentTypePlatformView)
+    {
+      geometry.rect = ScaleRect(geometry.rect, 1 / content_scale_);
+      return geometry;
+    }
+
+    // Subsurfaces can only be moved, so clips are applied to the region the
+    // view shows through, approximated by its bounding rectangle.
+    FlutterTransformation transformation = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    const FlutterPlatformView &view = *layer.platform_view;
+    for (size_t i = 0; i < view.mutations_count; i++)
+    {
+      const FlutterPlatformViewMutation &mutation = *view.mutations[i];
+      switch (mutation.type)
+      {
+      case kFlutterPlatformViewMutationTypeOpacity:
+        geometry.opacity *= mutation.opacity;
+        break;
+      case kFlutterPlatformViewMutationTypeClipRect:
+        geometry.rect = IntersectRects(geometry.rect, MapRect(transformation, mutation.clip_rect));
+        break;
+      case kFlutterPlatformViewMutationTypeClipRoundedRect:
+        geometry.rect = IntersectRects(geometry.rect, MapRect(transformation, mutation.clip_rounded_rect.rect));
+        break;
+      case kFlutterPlatformViewMutationTypeTransformation:
+        transformation = ConcatTransformations(transformation, mutation.transformation);
+        break;
+      }
+    }
+    geometry.rect = IntersectRects(ScaleRect(geometry.rect, 1 / content_scale_), GetSurfaceRect());
+    return geometry;
+  }
+
+  void GLCompositor::DrawTexture(GLuint texture, const FlutterRect &rect, float u, float v)
+  {
+    // Convert to clip space, where y points up.
+    auto x0 = static_cast<float>(rect.left / surface_width_ * 2 - 1);
+    auto x1 = static_cast<float>(rect.right / surface_width_ * 2 - 1);
+    auto y0 = static_cast<float>(1 - rect.top / surface_height_ * 2);
+    auto y1 = static_cast<float>(1 - rect.bottom / surface_height_ * 2);
+
+    // The engine renders upright into a bottom-left anchored framebuffer, so
+    // the top of the layer is at the top of its content region.
+    const GLfloat positions[] = {x0, y1, x1, y1, x0, y0, x1, y0};
+    const GLfloat texcoords[] = {0, 0, u, 0, 0, v, u, v};
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glVertexAttribPointer(position_location_, 2, GL_FLOAT, GL_FALSE, 0, positions);
+    glVertexAttribPointer(texcoord_location_, 2, GL_FLOAT, GL_FALSE, 0, texcoords);
+    glEnableVertexAttribArray(position_location_);
+    glEnableVertexAttribArray(texcoord_location_);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisableVertexAttribArray(position_location_);
+    glDisableVertexAttribArray(texcoord_location_);
+  }
+
+} // namespace flutter
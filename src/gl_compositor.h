@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <GLES2/gl2.h>
+#include <vector>
+
+#include "backing_store_pool.h"
+#include "flutter_tizen.h"
+
+namespace flutter
+{
+  // Composites the layers produced by the engine into a framebuffer.
+  // Backing stores are textures drawn as quads, recycled through a
+  // BackingStorePool. Platform views are shown by subsurfaces below the window,
+  // so their layers make the window transparent where the view is visible.
+  // Layers rendered at a reduced render scale are stretched to the surface.
+  // Must be used on the render thread with the onscreen context current,
+  // including when it is destroyed.
+  class GLCompositor
+  {
+  public:
+    GLCompositor(int32_t surface_width, int32_t surface_height);
+    ~GLCompositor();
+
+    bool CreateBackingStore(const FlutterBackingStoreConfig &config, FlutterBackingStore *backing_store_out);
+    bool CollectBackingStore(const FlutterBackingStore &backing_store);
+
+    // Returns the region that differs from the last presented layers.
+    FlutterRect ComputeDamage(const FlutterLayer **layers, size_t layers_count);
+    // Draws the layers into |framebuffer|, touching only |repaint_rect|.
+    bool DrawLayers(const FlutterLayer **layers, size_t layers_count, const FlutterRect &repaint_rect,
+                    GLuint framebuffer = 0);
+    // Called once the frame has been presented.
+    void EndFrame();
+    // Damages the whole surface in the next frame, for example after frames
+    // were dropped without being presented.
+    void Invalidate();
+
+    void GetRenderStats(FlutterDesktopRenderStats *stats) const;
+    // The size of the last frame relative to the surface, as set by
+    // ComputeDamage().
+    double GetContentScale() const;
+
+  private:
+    int32_t surface_width_;
+    int32_t surface_height_;
+    BackingStorePool pool_;
+
+    GLuint program_ = 0;
+    GLint position_location_ = -1;
+    GLint texcoord_location_ = -1;
+    GLint texture_location_ = -1;
+
+    struct LayerGeometry
+    {
+      FlutterRect rect;
+      double opacity;
+    };
+
+    // The geometry of the last presented layers. A change in it damages the
+    // whole surface.
+    std::vector<LayerGeometry> last_layer_geometry_;
+    double content_scale_ = 1.0;
+
+    bool EnsureProgram();
+    FlutterRect GetSurfaceRect() const;
+    LayerGeometry GetLayerGeometry(const FlutterLayer &layer) const;
+    void DrawTexture(GLuint texture, const FlutterRect &rect, float u, float v);
+  };
+
+} // namespace flutter
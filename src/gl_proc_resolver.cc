@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "gl_proc_resolver.h"
+
+#include <EGL/egl.h>
+#include <dlfcn.h>
+#include <flutter_embedder.h>
+
+#include <cctype>
+#include <cstring>
+
+#include "logger.h"
+
+namespace flutter
+{
+  // Extension functions end with a vendor suffix such as OES or EXT, and are
+  // only guaranteed to be returned by eglGetProcAddress.
+  static bool IsExtensionProc(const char *name)
+  {
+    size_t length = strlen(name);
+    return length > 2 && isupper(name[length - 1]) && isupper(name[length - 2]);
+  }
+
+  GLProcResolver::~GLProcResolver()
+  {
+    if (library_)
+    {
+      dlclose(library_);
+    }
+  }
+
+  void *GLProcResolver::Resolve(const char *name)
+  {
+    if (name == nullptr)
+    {
+      return nullptr;
+    }
+
+    lookup_count_++;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = procs_.find(name);
+    if (it != procs_.end())
+    {
+      return it->second;
+    }
+
+    uint64_t start = FlutterEngineGetCurrentTime();
+
+    if (!library_opened_)
+    {
+      library_opened_ = true;
+      library_ = dlopen("libGLESv2.so", RTLD_NOW | RTLD_LOCAL);
+      if (!library_)
+      {
+        library_ = dlopen("libGLESv2.so.2", RTLD_NOW | RTLD_LOCAL);
+      }
+      if (!library_)
+      {
+        LogW("Could not open libGLESv2, using eglGetProcAddress only: %s", dlerror());
+      }
+    }
+
+    void *address = nullptr;
+    if (library_ && !IsExtensionProc(name))
+    {
+      address = dlsym(library_, name);
+    }
+    if (!address)
+    {
+      address = reinterpret_cast<void *>(::eglGetProcAddress(name));
+    }
+    procs_.emplace(name, address);
+
+    resolved_count_++;
+    resolve_time_nanos_ += FlutterEngineGetCurrentTime() - start;
+    return address;
+  }
+
+  void GLProcResolver::GetRenderStats(FlutterDesktopRenderStats *stats) const
+  {
+    stats->gl_proc_lookup_count = lookup_count_;
+    stats->gl_proc_resolved_count = resolved_count_;
+    stats->gl_proc_resolve_time_nanos = resolve_time_nanos_;
+  }
+
+} // namespace flutter
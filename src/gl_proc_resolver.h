@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "flutter_tizen.h"
+
+namespace flutter
+{
+  // Resolves the GL functions asked for by the engine, which asks for hundreds
+  // of them at startup. Core functions are looked up in libGLESv2 directly,
+  // because eglGetProcAddress is slow and, before EGL 1.5, may not return them
+  // at all. Results are cached. Can be used from any thread.
+  class GLProcResolver
+  {
+  public:
+    GLProcResolver() = default;
+    ~GLProcResolver();
+
+    void *Resolve(const char *name);
+    void GetRenderStats(FlutterDesktopRenderStats *stats) const;
+
+  private:
+    std::mutex mutex_;
+    // Opened on the first lookup.
+    void *library_ = nullptr;
+    bool library_opened_ = false;
+    // Failed lookups are cached as well.
+    std::unordered_map<std::string, void *> procs_;
+
+    std::atomic<uint64_t> lookup_count_{0};
+    std::atomic<uint64_t> resolved_count_{0};
+    std::atomic<uint64_t> resolve_time_nanos_{0};
+
+    // Disallow copy and assign operations.
+    GLProcResolver(const GLProcResolver &) = delete;
+    void operator=(const GLProcResolver &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "key_event_channel.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "logger.h"
+
+namespace flutter
+{
+  // The GTK (X11) key values of the keys that do not produce text.
+  static const struct
+  {
+    const char *name;
+    uint32_t value;
+  } kKeyValues[] = {
+      {"BackSpace", 0xff08},
+      {"Tab", 0xff09},
+      {"Return", 0xff0d},
+      {"Escape", 0xff1b},
+      {"Home", 0xff50},
+      {"Left", 0xff51},
+      {"Up", 0xff52},
+      {"Right", 0xff53},
+      {"Down", 0xff54},
+      {"Prior", 0xff55},
+      {"Next", 0xff56},
+      {"End", 0xff57},
+      {"Insert", 0xff63},
+      {"Menu", 0xff67},
+      {"KP_Enter", 0xff8d},
+      {"F1", 0xffbe},
+      {"F2", 0xffbf},
+      {"F3", 0xffc0},
+      {"F4", 0xffc1},
+      {"F5", 0xffc2},
+      {"F6", 0xffc3},
+      {"F7", 0xffc4},
+      {"F8", 0xffc5},
+      {"F9", 0xffc6},
+      {"F10", 0xffc7},
+      {"F11", 0xffc8},
+      {"F12", 0xffc9},
+      {"Shift_L", 0xffe1},
+      {"Shift_R", 0xffe2},
+      {"Control_L", 0xffe3},
+      {"Control_R", 0xffe4},
+      {"Caps_Lock", 0xffe5},
+      {"Alt_L", 0xffe9},
+      {"Alt_R", 0xffea},
+      {"Super_L", 0xffeb},
+      {"Super_R", 0xffec},
+      {"Delete", 0xffff},
+      {"XF86AudioLowerVolume", 0x1008ff11},
+      {"XF86AudioMute", 0x1008ff12},
+      {"XF86AudioRaiseVolume", 0x1008ff13},
+      {"XF86Back", 0x1008ff26},
+      {"XF86PowerOff", 0x1008ff2a},
+      {"XF86Menu", 0x1008ff65},
+  };
+
+  // Returns the first code point of the UTF-8 |text|, or 0 if it is empty or
+  // a control character.
+  static uint32_t GetCodePoint(const char *text)
+  {
+    auto *bytes = reinterpret_cast<const unsigned char *>(text);
+    if (!bytes)
+    {
+      return 0;
+    }
+    uint32_t code_point = bytes[0];
+    size_t length = 0;
+    if (code_point >= 0xf0)
+    {
+      code_point &= 0x07;
+      length = 3;
+    }
+    else if (code_point >= 0xe0)
+    {
+      code_point &= 0x0f;
+      length = 2;
+    }
+    else if (code_point >= 0xc0)
+    {
+      code_point &= 0x1f;
+      length = 1;
+    }
+    for (size_t i = 1; i <= length; i++)
+    {
+      if ((bytes[i] & 0xc0) != 0x80)
+      {
+        return 0;
+      }
+      code_point = (code_point << 6) | (bytes[i] & 0x3f);
+    }
+    return code_point < 0x20 || code_point == 0x7f ? 0 : code_point;
+  }
+
+  static uint32_t GetKeyValue(const char *key, uint32_t code_point)
+  {
+    if (key)
+    {
+      for (const auto &key_value : kKeyValues)
+      {
+        if (strcmp(key, key_value.name) == 0)
+        {
+          return key_value.value;
+        }
+      }
+    }
+    // Latin-1 key values are their code points, others are offset.
+    return code_point < 0x100 ? code_point : code_point | 0x01000000;
+  }
+
+  // Maps ecore modifiers and locks to the GDK modifier mask.
+  static unsigned int GetModifiers(unsigned int modifiers)
+  {
+    unsigned int mask = 0;
+    mask |= modifiers & ECORE_EVENT_MODIFIER_SHIFT ? 1 << 0 : 0;
+    mask |= modifiers & ECORE_EVENT_LOCK_CAPS ? 1 << 1 : 0;
+    mask |= modifiers & ECORE_EVENT_MODIFIER_CTRL ? 1 << 2 : 0;
+    mask |= modifiers & ECORE_EVENT_MODIFIER_ALT ? 1 << 3 : 0;
+    mask |= modifiers & ECORE_EVENT_LOCK_NUM ? 1 << 4 : 0;
+    mask |= modifiers & ECORE_EVENT_MODIFIER_WIN ? 1 << 28 : 0;
+    return mask;
+  }
+
+  static void CopyString(char *destination, size_t size, const char *source)
+  {
+    snprintf(destination, size, "%s", source ? source : "");
+  }
+
+  KeyEventChannel::KeyEventChannel(FlutterEngine engine, std::function<void(const KeyEvent &)> on_unhandled)
+      : engine_(engine), on_unhandled_(std::move(on_unhandled))
+  {
+  }
+
+  void KeyEventChannel::SendKeyEvent(const Ecore_Event_Key *event, bool is_down)
+  {
+    uint32_t code_point = GetCodePoint(event->string);
+    int length = snprintf(message_, sizeof(message_),
+                          "{\"keymap\":\"linux\",\"toolkit\":\"gtk\",\"type\":\"%s\",\"keyCode\":%u,"
+                          "\"scanCode\":%u,\"modifiers\":%u,\"unicodeScalarValues\":%u}",
+                          is_down ? "keydown" : "keyup", GetKeyValue(event->key, code_point),
+                          event->keycode, GetModifiers(event->modifiers), code_point);
+
+    PendingEvent *pending = nullptr;
+    for (PendingEvent &pending_event : pending_events_)
+    {
+      if (!pending_event.in_use)
+      {
+        pending = &pending_event;
+        break;
+      }
+    }
+
+    // The engine allocates response handles, which cannot be helped.
+    FlutterPlatformMessageResponseHandle *response_handle = nullptr;
+    if (pending)
+    {
+      pending->in_use = true;
+      pending->channel = this;
+      pending->event.is_down = is_down;
+      pending->event.modifiers = event->modifiers;
+      CopyString(pending->event.key, sizeof(pending->event.key), event->key);
+      CopyString(pending->event.string, sizeof(pending->event.string), event->string);
+      if (FlutterPlatformMessageCreateResponseHandle(engine_, OnResponse, pending, &response_handle) != kSuccess)
+      {
+        pending->in_use = false;
+        response_handle = nullptr;
+      }
+    }
+    else
+    {
+      LogW("Too many key events awaiting a response.");
+    }
+
+    FlutterPlatformMessage message = {};
+    message.struct_size = sizeof(message);
+    message.channel = "flutter/keyevent";
+    message.message = reinterpret_cast<const uint8_t *>(message_);
+    message.message_size = length;
+    message.response_handle = response_handle;
+    if (FlutterEngineSendPlatformMessage(engine_, &message) != kSuccess)
+    {
+      LogE("Could not send a key event.");
+      if (response_handle)
+      {
+        pending->in_use = false;
+      }
+    }
+    if (response_handle)
+    {
+      FlutterPlatformMessageReleaseResponseHandle(engine_, response_handle);
+    }
+  }
+
+  void KeyEventChannel::OnResponse(const uint8_t *data, size_t size, void *user_data)
+  {
+    auto *pending = reinterpret_cast<PendingEvent *>(user_data);
+    KeyEventChannel *channel = pending->channel;
+    KeyEvent event = pending->event;
+    pending->in_use = false;
+
+    // The response is {"handled":<bool>}, in the JSON message codec.
+    static constexpr char kHandled[] = "\"handled\":true";
+    static constexpr size_t kHandledLength = sizeof(kHandled) - 1;
+    bool handled = false;
+    for (size_t i = 0; data && i + kHandledLength <= size && !handled; i++)
+    {
+      handled = memcmp(data + i, kHandled, kHandledLength) == 0;
+    }
+    if (!handled && channel->on_unhandled_)
+    {
+      channel->on_unhandled_(event);
+    }
+  }
+
+} // namespace flutter
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <array>
+#include <functional>
+
+#include <Ecore_Input.h>
+
+namespace flutter
+{
+  // Sends key events to the framework on the flutter/keyevent channel, in the
+  // format of the GTK embedder. Messages are encoded into a fixed buffer, and
+  // the framework's responses are handled as they arrive, so that holding a key
+  // down neither allocates nor blocks the platform thread. Must be used on the
+  // platform thread.
+  class KeyEventChannel
+  {
+  public:
+    // The part of a key event kept until the framework has responded.
+    struct KeyEvent
+    {
+      bool is_down;
+      unsigned int modifiers;
+      // The ecore key name and the UTF-8 text it produces, truncated.
+      char key[32];
+      char string[16];
+    };
+
+    // |on_unhandled| is called with the events the framework did not handle.
+    KeyEventChannel(FlutterEngine engine, std::function<void(const KeyEvent &)> on_unhandled);
+
+    void SendKeyEvent(const Ecore_Event_Key *event, bool is_down);
+
+  private:
+    // Events beyond this many awaiting a response are sent without one.
+    static constexpr size_t kMaxPendingEvents = 16;
+
+    struct PendingEvent
+    {
+      bool in_use;
+      KeyEventChannel *channel;
+      KeyEvent event;
+    };
+
+    FlutterEngine engine_;
+    std::function<void(const KeyEvent &)> on_unhandled_;
+    std::array<PendingEvent, kMaxPendingEvents> pending_events_ = {};
+    char message_[256];
+
+    static void OnResponse(const uint8_t *data, size_t size, void *user_data);
+
+    // Disallow copy and assign operations.
+    KeyEventChannel(const KeyEventChannel &) = delete;
+    void operator=(const KeyEventChannel &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,557 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "offscreen_display.h"
+
+#include <cstring>
+
+#include "logger.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+#ifndef EGL_OPENGL_ES3_BIT_KHR
+#define EGL_OPENGL_ES3_BIT_KHR 0x0040
+#endif
+
+namespace flutter
+{
+  static bool HasExtension(const char *extensions, const char *name)
+  {
+    if (!extensions)
+    {
+      return false;
+    }
+
+    size_t length = strlen(name);
+    for (const char *found = strstr(extensions, name); found; found = strstr(found + length, name))
+    {
+      bool starts = found == extensions || found[-1] == ' ';
+      bool ends = found[length] == ' ' || found[length] == '\0';
+      if (starts && ends)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  OffscreenDisplay::OffscreenDisplay(uint32_t width, uint32_t height, const FlutterDesktopOffscreenTarget &target)
+      : width_(width), height_(height), target_(target)
+  {
+    if (!target_.buffer || target_.row_bytes < static_cast<size_t>(width_) * 4)
+    {
+      LogE("The offscreen target buffer is too small.");
+      return;
+    }
+
+    // Setup the EGL display, without a window system if possible.
+    {
+      const char *client_extensions = ::eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+      auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          ::eglGetProcAddress("eglGetPlatformDisplayEXT"));
+      if (get_platform_display && HasExtension(client_extensions, "EGL_MESA_platform_surfaceless"))
+      {
+        display_ = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      }
+      if (display_ == EGL_NO_DISPLAY)
+      {
+        display_ = ::eglGetDisplay(EGL_DEFAULT_DISPLAY);
+      }
+      if (display_ == EGL_NO_DISPLAY)
+      {
+        LogE("Could not get the EGL display.");
+        return;
+      }
+
+      if (::eglInitialize(display_, nullptr, nullptr) != EGL_TRUE)
+      {
+        LogE("Could not initialize the EGL display.");
+        return;
+      }
+    }
+
+    bool surfaceless = HasExtension(::eglQueryString(display_, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+
+    // Choose an EGL config and create the EGL contexts. Pixel buffer objects
+    // need OpenGL ES 3, which the config has to support as well.
+    EGLConfig config = {0};
+    {
+      auto choose_config = [&](EGLint renderable_type) {
+        EGLint num_config = 0;
+        const EGLint attribute_list[] = {
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, renderable_type,
+            EGL_NONE};
+        return ::eglChooseConfig(display_, attribute_list, &config, 1, &num_config) == EGL_TRUE && num_config > 0;
+      };
+
+      const EGLint es3_attributes[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+      const EGLint es2_attributes[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+
+      const EGLint *context_attributes = es3_attributes;
+      if (choose_config(EGL_OPENGL_ES3_BIT_KHR))
+      {
+        context_ = ::eglCreateContext(display_, config, EGL_NO_CONTEXT, context_attributes);
+      }
+      if (context_ == EGL_NO_CONTEXT)
+      {
+        LogW("OpenGL ES 3 is not available, frames are read back synchronously.");
+        context_attributes = es2_attributes;
+        if (!choose_config(EGL_OPENGL_ES2_BIT))
+        {
+          LogE("Could not choose an EGL config.");
+          return;
+        }
+        context_ = ::eglCreateContext(display_, config, EGL_NO_CONTEXT, context_attributes);
+      }
+      else
+      {
+        pixel_buffers_supported_ = true;
+      }
+      if (context_ == EGL_NO_CONTEXT)
+      {
+        LogE("Could not create the EGL context.");
+        return;
+      }
+
+      resource_context_ = ::eglCreateContext(display_, config, context_, context_attributes);
+      if (resource_context_ == EGL_NO_CONTEXT)
+      {
+        LogE("Could not create the EGL resource context.");
+        return;
+      }
+    }
+
+    // All rendering goes into a framebuffer object, so a surface is only
+    // created where the context cannot be made current without one.
+    if (!surfaceless)
+    {
+      const EGLint surface_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+      surface_ = ::eglCreatePbufferSurface(display_, config, surface_attributes);
+      resource_surface_ = ::eglCreatePbufferSurface(display_, config, surface_attributes);
+      if (surface_ == EGL_NO_SURFACE || resource_surface_ == EGL_NO_SURFACE)
+      {
+        LogE("Could not create the EGL pbuffer surface.");
+        return;
+      }
+    }
+
+    compositor_ = std::make_unique<GLCompositor>(width_, height_);
+    valid_ = true;
+  }
+
+  OffscreenDisplay::~OffscreenDisplay()
+  {
+    if (context_ != EGL_NO_CONTEXT &&
+        ::eglMakeCurrent(display_, surface_, surface_, context_) == EGL_TRUE)
+    {
+      // The frames still being read back are delivered rather than lost.
+      for (size_t i = 0; i < kReadbackCount; i++)
+      {
+        Readback &readback = readbacks_[(next_readback_ + i) % kReadbackCount];
+        FinishReadback(readback, true);
+        if (readback.pixel_buffer)
+        {
+          glDeleteBuffers(1, &readback.pixel_buffer);
+        }
+      }
+      if (framebuffer_)
+      {
+        glDeleteFramebuffers(1, &framebuffer_);
+      }
+      if (renderbuffer_)
+      {
+        glDeleteRenderbuffers(1, &renderbuffer_);
+      }
+      compositor_.reset();
+      ::eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+    if (surface_ != EGL_NO_SURFACE)
+    {
+      ::eglDestroySurface(display_, surface_);
+      surface_ = EGL_NO_SURFACE;
+    }
+
+    if (resource_surface_ != EGL_NO_SURFACE)
+    {
+      ::eglDestroySurface(display_, resource_surface_);
+      resource_surface_ = EGL_NO_SURFACE;
+    }
+
+    if (context_ != EGL_NO_CONTEXT)
+    {
+      ::eglDestroyContext(display_, context_);
+      context_ = EGL_NO_CONTEXT;
+    }
+
+    if (resource_context_ != EGL_NO_CONTEXT)
+    {
+      ::eglDestroyContext(display_, resource_context_);
+      resource_context_ = EGL_NO_CONTEXT;
+    }
+
+    if (display_ != EGL_NO_DISPLAY)
+    {
+      ::eglTerminate(display_);
+      display_ = EGL_NO_DISPLAY;
+    }
+  }
+
+  bool OffscreenDisplay::IsValid() const { return valid_; }
+
+  size_t OffscreenDisplay::GetWidth() const { return width_; }
+
+  size_t OffscreenDisplay::GetHeight() const { return height_; }
+
+  void OffscreenDisplay::GetRenderStats(FlutterDesktopRenderStats *stats) const
+  {
+    if (compositor_)
+    {
+      compositor_->GetRenderStats(stats);
+    }
+    proc_resolver_.GetRenderStats(stats);
+  }
+
+  void OffscreenDisplay::FlushFrames()
+  {
+    if (!pixel_buffers_supported_ || !OnApplicationContextMakeCurrent())
+    {
+      return;
+    }
+
+    for (size_t i = 0; i < kReadbackCount; i++)
+    {
+      FinishReadback(readbacks_[(next_readback_ + i) % kReadbackCount], true);
+    }
+  }
+
+  bool OffscreenDisplay::EnsureFramebuffer()
+  {
+    if (framebuffer_)
+    {
+      return true;
+    }
+
+    glGenRenderbuffers(1, &renderbuffer_);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer_);
+    // GL_RGBA8 has the same value as GL_RGBA8_OES, which OpenGL ES 2 only
+    // supports with GL_OES_rgb8_rgba8.
+    GLenum format = GL_RGBA8;
+    if (!pixel_buffers_supported_ &&
+        !HasExtension(reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS)), "GL_OES_rgb8_rgba8"))
+    {
+      LogW("GL_OES_rgb8_rgba8 is not supported, frames are rendered with 4 bits per channel.");
+      format = GL_RGBA4;
+    }
+    glRenderbufferStorage(GL_RENDERBUFFER, format, width_, height_);
+
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      LogE("The offscreen framebuffer is incomplete.");
+      glDeleteFramebuffers(1, &framebuffer_);
+      glDeleteRenderbuffers(1, &renderbuffer_);
+      framebuffer_ = 0;
+      renderbuffer_ = 0;
+      return false;
+    }
+
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return true;
+  }
+
+  void OffscreenDisplay::StartReadback()
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    uint64_t frame_number = frame_number_++;
+
+    if (!pixel_buffers_supported_)
+    {
+      pixels_.resize(static_cast<size_t>(width_) * height_ * 4);
+      glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.data());
+      CopyRows(pixels_.data());
+      if (target_.frame_callback)
+      {
+        target_.frame_callback(target_.user_data, frame_number);
+      }
+      return;
+    }
+
+    // The ring is full: the oldest frame has to be delivered first.
+    Readback &readback = readbacks_[next_readback_];
+    FinishReadback(readback, true);
+
+    if (!readback.pixel_buffer)
+    {
+      glGenBuffers(1, &readback.pixel_buffer);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixel_buffer);
+      glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width_) * height_ * 4, nullptr, GL_STREAM_READ);
+    }
+    else
+    {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixel_buffer);
+    }
+    glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.frame_number = frame_number;
+    glFlush();
+    next_readback_ = (next_readback_ + 1) % kReadbackCount;
+
+    // Deliver the frames the GPU is already done with, in order.
+    for (size_t i = 0; i < kReadbackCount; i++)
+    {
+      Readback &pending = readbacks_[(next_readback_ + i) % kReadbackCount];
+      if (pending.fence && !FinishReadback(pending, false))
+      {
+        break;
+      }
+    }
+  }
+
+  bool OffscreenDisplay::FinishReadback(Readback &readback, bool wait)
+  {
+    if (!readback.fence)
+    {
+      return true;
+    }
+
+    GLenum status = glClientWaitSync(readback.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                     wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+      return false;
+    }
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+    if (status == GL_WAIT_FAILED)
+    {
+      LogE("Could not wait for frame %llu.", static_cast<unsigned long long>(readback.frame_number));
+      return true;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixel_buffer);
+    auto *pixels = static_cast<const uint8_t *>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(width_) * height_ * 4, GL_MAP_READ_BIT));
+    if (pixels)
+    {
+      CopyRows(pixels);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (pixels && target_.frame_callback)
+    {
+      target_.frame_callback(target_.user_data, readback.frame_number);
+    }
+    return true;
+  }
+
+  void OffscreenDisplay::CopyRows(const uint8_t *pixels)
+  {
+    // OpenGL reads bottom-up, the target is top-down.
+    size_t row_size = static_cast<size_t>(width_) * 4;
+    auto *target = static_cast<uint8_t *>(target_.buffer);
+    for (int32_t y = 0; y < height_; y++)
+    {
+      memcpy(target + y * target_.row_bytes, pixels + (height_ - 1 - y) * row_size, row_size);
+    }
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  FlutterRendererType OffscreenDisplay::GetRendererType() const
+  {
+    return kOpenGL;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationPresentSoftware(const void *allocation, size_t row_bytes, size_t height)
+  {
+    return false;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationPresentHeldFrame() { return true; }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationContextMakeCurrent()
+  {
+    if (!valid_)
+    {
+      LogE("Cannot make an invalid display current.");
+      return false;
+    }
+
+    if (::eglMakeCurrent(display_, surface_, surface_, context_) != EGL_TRUE)
+    {
+      LogE("Could not make the onscreen context current.");
+      return false;
+    }
+
+    return true;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationContextMakeResourceCurrent()
+  {
+    if (!valid_)
+    {
+      LogE("Cannot make an invalid resource current.");
+      return false;
+    }
+
+    if (::eglMakeCurrent(display_, resource_surface_, resource_surface_, resource_context_) != EGL_TRUE)
+    {
+      LogE("Could not make the resource context current.");
+      return false;
+    }
+
+    return true;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationContextClearCurrent()
+  {
+    if (!valid_)
+    {
+      LogE("Cannot clear an invalid display.");
+      return false;
+    }
+
+    if (::eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) != EGL_TRUE)
+    {
+      LogE("Could not clear the current context.");
+      return false;
+    }
+
+    return true;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationPresent()
+  {
+    if (!valid_ || !framebuffer_)
+    {
+      LogE("Cannot present an invalid display.");
+      return false;
+    }
+
+    StartReadback();
+    return true;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  FlutterRect OffscreenDisplay::OnApplicationSetFrameDamage(const FlutterRect &damage)
+  {
+    // The framebuffer keeps its contents between frames.
+    return damage;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationCreateBackingStore(const FlutterBackingStoreConfig &config,
+                                                         FlutterBackingStore *backing_store_out)
+  {
+    if (!compositor_ || !OnApplicationContextMakeCurrent())
+    {
+      return false;
+    }
+
+    if (!compositor_->CreateBackingStore(config, backing_store_out))
+    {
+      LogE("Could not create a backing store.");
+      return false;
+    }
+    return true;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationCollectBackingStore(const FlutterBackingStore &backing_store)
+  {
+    if (!compositor_ || !OnApplicationContextMakeCurrent())
+    {
+      return false;
+    }
+
+    return compositor_->CollectBackingStore(backing_store);
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool OffscreenDisplay::OnApplicationPresentLayers(const FlutterLayer **layers, size_t layers_count)
+  {
+    if (!compositor_ || !OnApplicationContextMakeCurrent() || !EnsureFramebuffer())
+    {
+      return false;
+    }
+
+    FlutterRect damage = compositor_->ComputeDamage(layers, layers_count);
+    FlutterRect repaint_rect = OnApplicationSetFrameDamage(damage);
+    if (!compositor_->DrawLayers(layers, layers_count, repaint_rect, framebuffer_))
+    {
+      LogE("Could not composite the layers.");
+      return false;
+    }
+
+    bool result = OnApplicationPresent();
+    compositor_->EndFrame();
+    return result;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void OffscreenDisplay::OnApplicationFrameDropped()
+  {
+    if (compositor_)
+    {
+      compositor_->Invalidate();
+    }
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void OffscreenDisplay::OnApplicationSetBufferRotation(int32_t degrees) {}
+
+  // |FlutterApplication::RenderDelegate|
+  void *OffscreenDisplay::OnApplicationCreateExternalImage(const FlutterDesktopExternalBuffer &buffer)
+  {
+    // Buffers are imported through the window system, which is not used here.
+    return nullptr;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void OffscreenDisplay::OnApplicationDestroyExternalImage(void *image) {}
+
+  // |FlutterApplication::RenderDelegate|
+  uint32_t OffscreenDisplay::OnApplicationGetOnscreenFBO()
+  {
+    return EnsureFramebuffer() ? framebuffer_ : 0;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void *OffscreenDisplay::GetProcAddress(const char *name)
+  {
+    return proc_resolver_.Resolve(name);
+  }
+
+} // namespace flutter
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#include <memory>
+#include <vector>
+
+#include "flutter_application.h"
+#include "flutter_tizen.h"
+#include "gl_compositor.h"
+#include "gl_proc_resolver.h"
+
+namespace flutter
+{
+  // Renders without a window, into a framebuffer object on a surfaceless or
+  // pbuffer EGL context, and copies every frame into a caller-provided buffer.
+  // With an OpenGL ES 3 context the copy goes through a ring of pixel buffer
+  // objects, so that the render thread does not wait for the GPU to finish a
+  // frame before starting the next one.
+  class OffscreenDisplay : public FlutterApplication::RenderDelegate
+  {
+  public:
+    OffscreenDisplay(uint32_t width, uint32_t height, const FlutterDesktopOffscreenTarget &target);
+    virtual ~OffscreenDisplay();
+    bool IsValid() const;
+    size_t GetWidth() const;
+    size_t GetHeight() const;
+    void GetRenderStats(FlutterDesktopRenderStats *stats) const;
+
+    // Waits for the frames being read back and copies them into the target.
+    // Must be called on the render thread.
+    void FlushFrames();
+
+  private:
+    struct Readback
+    {
+      GLuint pixel_buffer;
+      GLsync fence;
+      uint64_t frame_number;
+    };
+
+    static constexpr size_t kReadbackCount = 3;
+
+    int32_t width_;
+    int32_t height_;
+    FlutterDesktopOffscreenTarget target_;
+
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLContext context_ = EGL_NO_CONTEXT;
+    EGLContext resource_context_ = EGL_NO_CONTEXT;
+    // EGL_NO_SURFACE with EGL_KHR_surfaceless_context.
+    EGLSurface surface_ = EGL_NO_SURFACE;
+    EGLSurface resource_surface_ = EGL_NO_SURFACE;
+    bool pixel_buffers_supported_ = false;
+
+    // Created on the render thread.
+    GLuint framebuffer_ = 0;
+    GLuint renderbuffer_ = 0;
+    std::unique_ptr<GLCompositor> compositor_;
+    GLProcResolver proc_resolver_;
+
+    // Ordered oldest first, starting at |next_readback_|.
+    Readback readbacks_[kReadbackCount] = {};
+    size_t next_readback_ = 0;
+    uint64_t frame_number_ = 0;
+    // Used when pixel buffer objects are not supported.
+    std::vector<uint8_t> pixels_;
+
+    bool valid_ = false;
+
+    bool EnsureFramebuffer();
+    void StartReadback();
+    bool FinishReadback(Readback &readback, bool wait);
+    void CopyRows(const uint8_t *pixels);
+
+    // |FlutterApplication::RenderDelegate|
+    FlutterRendererType GetRendererType() const override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationPresentSoftware(const void *allocation, size_t row_bytes, size_t height) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationPresentHeldFrame() override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationContextMakeCurrent() override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationContextMakeResourceCurrent() override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationContextClearCurrent() override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationPresent() override;
+    // |FlutterApplication::RenderDelegate|
+    FlutterRect OnApplicationSetFrameDamage(const FlutterRect &damage) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationCreateBackingStore(const FlutterBackingStoreConfig &config,
+                                         FlutterBackingStore *backing_store_out) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationCollectBackingStore(const FlutterBackingStore &backing_store) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationPresentLayers(const FlutterLayer **layers, size_t layers_count) override;
+    // |FlutterApplication::RenderDelegate|
+    void OnApplicationFrameDropped() override;
+    // |FlutterApplication::RenderDelegate|
+    void OnApplicationSetBufferRotation(int32_t degrees) override;
+    // |FlutterApplication::RenderDelegate|
+    void *OnApplicationCreateExternalImage(const FlutterDesktopExternalBuffer &buffer) override;
+    // |FlutterApplication::RenderDelegate|
+    void OnApplicationDestroyExternalImage(void *image) override;
+    // |FlutterApplication::RenderDelegate|
+    uint32_t OnApplicationGetOnscreenFBO() override;
+    // |FlutterApplication::RenderDelegate|
+    void *GetProcAddress(const char *) override;
+
+    // Disallow copy and assign operations.
+    OffscreenDisplay(const OffscreenDisplay &) = delete;
+    void operator=(const OffscreenDisplay &) = delete;
+  };
+
+} // namespace flutter
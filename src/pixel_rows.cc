@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "pixel_rows.h"
+
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXEL_ROWS_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXEL_ROWS_SSE2 1
+#endif
+
+namespace flutter
+{
+  static inline uint16_t PackRGB565(uint32_t pixel)
+  {
+    uint32_t b = pixel & 0xff;
+    uint32_t g = (pixel >> 8) & 0xff;
+    uint32_t r = (pixel >> 16) & 0xff;
+    return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+  }
+
+  void CopyRow(void *dst, const void *src, size_t bytes)
+  {
+    auto *d = static_cast<uint8_t *>(dst);
+    auto *s = static_cast<const uint8_t *>(src);
+    size_t i = 0;
+
+#if defined(PIXEL_ROWS_NEON)
+    for (; i + 64 <= bytes; i += 64)
+    {
+      uint8x16_t a = vld1q_u8(s + i);
+      uint8x16_t b = vld1q_u8(s + i + 16);
+      uint8x16_t c = vld1q_u8(s + i + 32);
+      uint8x16_t e = vld1q_u8(s + i + 48);
+      vst1q_u8(d + i, a);
+      vst1q_u8(d + i + 16, b);
+      vst1q_u8(d + i + 32, c);
+      vst1q_u8(d + i + 48, e);
+    }
+#elif defined(PIXEL_ROWS_SSE2)
+    // Streaming stores need an aligned destination.
+    for (; i < bytes && (reinterpret_cast<uintptr_t>(d + i) & 15); i++)
+    {
+      d[i] = s[i];
+    }
+    for (; i + 64 <= bytes; i += 64)
+    {
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+      __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + 16));
+      __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + 32));
+      __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + 48));
+      _mm_stream_si128(reinterpret_cast<__m128i *>(d + i), a);
+      _mm_stream_si128(reinterpret_cast<__m128i *>(d + i + 16), b);
+      _mm_stream_si128(reinterpret_cast<__m128i *>(d + i + 32), c);
+      _mm_stream_si128(reinterpret_cast<__m128i *>(d + i + 48), e);
+    }
+    _mm_sfence();
+#endif
+
+    if (i < bytes)
+    {
+      memcpy(d + i, s + i, bytes - i);
+    }
+  }
+
+  void ConvertRowToRGB565(uint16_t *dst, const uint32_t *src, size_t pixels)
+  {
+    size_t i = 0;
+
+#if defined(PIXEL_ROWS_NEON)
+    for (; i + 8 <= pixels; i += 8)
+    {
+      // De-interleaves into B, G, R and A lanes.
+      uint8x8x4_t bgra = vld4_u8(reinterpret_cast<const uint8_t *>(src + i));
+      uint16x8_t r = vshll_n_u8(vshr_n_u8(bgra.val[2], 3), 8);
+      uint16x8_t g = vshll_n_u8(vshr_n_u8(bgra.val[1], 2), 8);
+      uint16x8_t b = vshll_n_u8(vshr_n_u8(bgra.val[0], 3), 8);
+      uint16x8_t rgb = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(g, 3));
+      rgb = vorrq_u16(rgb, vshrq_n_u16(b, 8));
+      vst1q_u16(dst + i, rgb);
+    }
+#elif defined(PIXEL_ROWS_SSE2)
+    const __m128i mask_b = _mm_set1_epi32(0x000000f8);
+    const __m128i mask_g = _mm_set1_epi32(0x0000fc00);
+    const __m128i mask_r = _mm_set1_epi32(0x00f80000);
+    for (; i + 8 <= pixels; i += 8)
+    {
+      __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4));
+
+      __m128i lo_rgb = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(_mm_and_si128(lo, mask_b), 3),
+                                                 _mm_srli_epi32(_mm_and_si128(lo, mask_g), 5)),
+                                    _mm_srli_epi32(_mm_and_si128(lo, mask_r), 8));
+      __m128i hi_rgb = _mm_or_si128(_mm_or_si128(_mm_srli_epi32(_mm_and_si128(hi, mask_b), 3),
+                                                 _mm_srli_epi32(_mm_and_si128(hi, mask_g), 5)),
+                                    _mm_srli_epi32(_mm_and_si128(hi, mask_r), 8));
+
+      // Values fit in 16 bits, but packs saturates signed, so sign-extend the
+      // low halves first to keep the top bit.
+      lo_rgb = _mm_srai_epi32(_mm_slli_epi32(lo_rgb, 16), 16);
+      hi_rgb = _mm_srai_epi32(_mm_slli_epi32(hi_rgb, 16), 16);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(lo_rgb, hi_rgb));
+    }
+#endif
+
+    for (; i < pixels; i++)
+    {
+      dst[i] = PackRGB565(src[i]);
+    }
+  }
+
+} // namespace flutter
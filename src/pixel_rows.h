@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter
+{
+  // Row operations used to move software-rendered frames into shared memory.
+  // NEON and SSE2 versions are picked at compile time, with a scalar fallback.
+
+  // Copies |bytes| from |src| to |dst|, bypassing the cache where the
+  // architecture allows, since the destination is only read by the display
+  // server.
+  void CopyRow(void *dst, const void *src, size_t bytes);
+
+  // Converts premultiplied BGRA8888 pixels, the engine's native order, to
+  // RGB565.
+  void ConvertRowToRGB565(uint16_t *dst, const uint32_t *src, size_t pixels);
+
+} // namespace flutter
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "platform_task_runner.h"
+
+#include "logger.h"
+
+namespace flutter
+{
+  PlatformTaskRunner::PlatformTaskRunner() : TaskRunner(kIdentifier)
+  {
+    thread_id_ = std::this_thread::get_id();
+
+    if (!IsValid())
+    {
+      return;
+    }
+
+    fd_handler_ = ecore_main_fd_handler_add(timer_fd_, ECORE_FD_READ, OnTimerReadable, this, nullptr, nullptr);
+    if (!fd_handler_)
+    {
+      LogE("Could not watch the platform task runner timerfd.");
+    }
+  }
+
+  PlatformTaskRunner::~PlatformTaskRunner()
+  {
+    if (fd_handler_)
+    {
+      ecore_main_fd_handler_del(fd_handler_);
+      fd_handler_ = nullptr;
+    }
+  }
+
+  Eina_Bool PlatformTaskRunner::OnTimerReadable(void *data, Ecore_Fd_Handler *handler)
+  {
+    reinterpret_cast<PlatformTaskRunner *>(data)->RunExpiredTasks();
+    return ECORE_CALLBACK_RENEW;
+  }
+
+} // namespace flutter
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <Ecore.h>
+
+#include "task_runner.h"
+
+namespace flutter
+{
+  // Runs platform tasks on the ecore main loop thread, so that platform
+  // messages and input handlers share one thread with the engine's platform
+  // task runner. Must be created on the main loop thread.
+  class PlatformTaskRunner : public TaskRunner
+  {
+  public:
+    PlatformTaskRunner();
+    virtual ~PlatformTaskRunner();
+
+  private:
+    static constexpr size_t kIdentifier = 1;
+
+    Ecore_Fd_Handler *fd_handler_ = nullptr;
+
+    static Eina_Bool OnTimerReadable(void *data, Ecore_Fd_Handler *handler);
+  };
+
+} // namespace flutter
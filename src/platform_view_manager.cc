@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "platform_view_manager.h"
+
+#include <cmath>
+
+#include "logger.h"
+
+namespace flutter
+{
+  PlatformViewManager::PlatformViewManager(Ecore_Wl2_Window *window)
+      : window_(window), window_surface_(ecore_wl2_window_surface_get(window)) {}
+
+  PlatformViewManager::~PlatformViewManager()
+  {
+    for (auto &view : views_)
+    {
+      ecore_wl2_subsurface_del(view.second);
+    }
+    views_.clear();
+  }
+
+  wl_surface *PlatformViewManager::CreateView(FlutterPlatformViewIdentifier view_id)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (views_.find(view_id) != views_.end())
+    {
+      LogE("Platform view %lld already exists.", static_cast<long long>(view_id));
+      return nullptr;
+    }
+
+    Ecore_Wl2_Subsurface *subsurface = ecore_wl2_subsurface_new(window_);
+    if (!subsurface)
+    {
+      LogE("Could not create a subsurface for platform view %lld.", static_cast<long long>(view_id));
+      return nullptr;
+    }
+
+    // Let the content update at its own rate. Position and stacking changes
+    // still wait for the window commit.
+    ecore_wl2_subsurface_sync_set(subsurface, EINA_FALSE);
+    ecore_wl2_subsurface_place_below(subsurface, window_surface_);
+
+    if (views_.empty())
+    {
+      // Views show through transparent regions of the window.
+      ecore_wl2_window_alpha_set(window_, EINA_TRUE);
+    }
+    views_[view_id] = subsurface;
+
+    return ecore_wl2_subsurface_surface_get(subsurface);
+  }
+
+  bool PlatformViewManager::DestroyView(FlutterPlatformViewIdentifier view_id)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = views_.find(view_id);
+    if (it == views_.end())
+    {
+      return false;
+    }
+
+    ecore_wl2_subsurface_del(it->second);
+    views_.erase(it);
+
+    if (views_.empty())
+    {
+      ecore_wl2_window_alpha_set(window_, EINA_FALSE);
+    }
+    return true;
+  }
+
+  void PlatformViewManager::PlaceViews(const FlutterLayer **layers, size_t layers_count, double content_scale)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (views_.empty())
+    {
+      return;
+    }
+
+    // Each view placed directly below the window ends up above the ones
+    // placed before it, which matches the bottom-to-top layer order. Views
+    // that are not part of the frame stay covered by the opaque window.
+    for (size_t i = 0; i < layers_count; i++)
+    {
+      const FlutterLayer &layer = *layers[i];
+      if (layer.type != kFlutterLayerContentTypePlatformView)
+      {
+        continue;
+      }
+
+      auto it = views_.find(layer.platform_view->identifier);
+      if (it == views_.end())
+      {
+        continue;
+      }
+
+      ecore_wl2_subsurface_position_set(it->second,
+                                        static_cast<int>(std::round(layer.offset.x / content_scale)),
+                                        static_cast<int>(std::round(layer.offset.y / content_scale)));
+      ecore_wl2_subsurface_place_below(it->second, window_surface_);
+    }
+  }
+
+} // namespace flutter
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <mutex>
+#include <unordered_map>
+#define EFL_BETA_API_SUPPORT
+#include <Ecore_Wl2.h>
+
+namespace flutter
+{
+  // Shows platform views as subsurfaces stacked below the application window,
+  // so that the display server can scan native content such as video out on
+  // an overlay plane. The window is made translucent where a view is visible
+  // by the GLCompositor. Views are created and destroyed on the main thread
+  // and placed on the render thread, right before the window is committed.
+  class PlatformViewManager
+  {
+  public:
+    explicit PlatformViewManager(Ecore_Wl2_Window *window);
+    ~PlatformViewManager();
+
+    // Returns the surface native content of the view should be presented to,
+    // at the size of the view.
+    wl_surface *CreateView(FlutterPlatformViewIdentifier view_id);
+    bool DestroyView(FlutterPlatformViewIdentifier view_id);
+
+    // Positions and stacks the views that are part of the frame. Takes effect
+    // with the next commit of the window. Layer offsets are divided by
+    // |content_scale| to get window coordinates.
+    void PlaceViews(const FlutterLayer **layers, size_t layers_count, double content_scale);
+
+  private:
+    Ecore_Wl2_Window *window_;
+    wl_surface *window_surface_;
+
+    std::mutex mutex_;
+    std::unordered_map<FlutterPlatformViewIdentifier, Ecore_Wl2_Subsurface *> views_;
+
+    // Disallow copy and assign operations.
+    PlatformViewManager(const PlatformViewManager &) = delete;
+    void operator=(const PlatformViewManager &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "pointer_event_queue.h"
+
+#include <cstring>
+
+#include "logger.h"
+
+namespace flutter
+{
+  PointerEventQueue::PointerEventQueue(FlutterEngine engine, FlutterDesktopPointerBatching batching,
+                                       std::unique_ptr<PointerResampler> resampler)
+      : engine_(engine), batching_(batching)
+  {
+    if (batching_ == kFlutterDesktopPointerBatchingVsync)
+    {
+      resampler_ = std::move(resampler);
+      vsync_pipe_ = ecore_pipe_add(OnVsyncPipe, this);
+      if (!vsync_pipe_)
+      {
+        LogE("Could not create the pointer vsync pipe.");
+        return;
+      }
+    }
+    valid_ = true;
+  }
+
+  PointerEventQueue::~PointerEventQueue()
+  {
+    if (idle_enterer_)
+    {
+      ecore_idle_enterer_del(idle_enterer_);
+    }
+    if (vsync_timer_)
+    {
+      ecore_timer_del(vsync_timer_);
+    }
+    if (vsync_pipe_)
+    {
+      ecore_pipe_del(vsync_pipe_);
+    }
+  }
+
+  bool PointerEventQueue::IsValid() const { return valid_; }
+
+  void PointerEventQueue::Push(const FlutterPointerEvent &event)
+  {
+    if (batching_ == kFlutterDesktopPointerBatchingImmediate &&
+        event.signal_kind != kFlutterPointerSignalKindScroll)
+    {
+      // Scrolls held back in this iteration go first.
+      Flush();
+      FlutterEngineSendPointerEvent(engine_, &event, 1);
+      return;
+    }
+
+    if (resampler_ && event.device_kind == kFlutterPointerDeviceKindTouch)
+    {
+      PushTouch(event);
+      return;
+    }
+
+    if (!MergeScroll(event))
+    {
+      if (count_ == kCapacity)
+      {
+        Flush();
+      }
+      events_[count_++] = event;
+    }
+
+    // Even without batching, a fast wheel or bezel spin is sent as one scroll
+    // per main loop iteration.
+    if (batching_ != kFlutterDesktopPointerBatchingVsync)
+    {
+      if (!idle_enterer_)
+      {
+        idle_enterer_ = ecore_idle_enterer_add(OnIdleEnterer, this);
+      }
+      return;
+    }
+
+    if (event.phase != kMove && event.phase != kHover)
+    {
+      // Presses and releases are not held back, and take the moves before them
+      // along.
+      Flush();
+      return;
+    }
+    waiting_for_vsync_ = true;
+    if (!vsync_timer_)
+    {
+      vsync_timer_ = ecore_timer_add(kVsyncTimeout, OnVsyncTimeout, this);
+    }
+  }
+
+  bool PointerEventQueue::MergeScroll(const FlutterPointerEvent &event)
+  {
+    if (event.signal_kind != kFlutterPointerSignalKindScroll || count_ == 0)
+    {
+      return false;
+    }
+    FlutterPointerEvent &last = events_[count_ - 1];
+    if (last.signal_kind != kFlutterPointerSignalKindScroll || last.device != event.device ||
+        last.phase != event.phase || last.buttons != event.buttons)
+    {
+      return false;
+    }
+    double scroll_delta_x = last.scroll_delta_x + event.scroll_delta_x;
+    double scroll_delta_y = last.scroll_delta_y + event.scroll_delta_y;
+    last = event;
+    last.scroll_delta_x = scroll_delta_x;
+    last.scroll_delta_y = scroll_delta_y;
+    return true;
+  }
+
+  void PointerEventQueue::PushTouch(FlutterPointerEvent event)
+  {
+    switch (event.phase)
+    {
+    case kMove:
+      resampler_->AddSample(event);
+      resample_pending_ = true;
+      waiting_for_vsync_ = true;
+      if (!vsync_timer_)
+      {
+        vsync_timer_ = ecore_timer_add(kVsyncTimeout, OnVsyncTimeout, this);
+      }
+      return;
+    case kDown:
+      // The press starts a new history.
+      event.timestamp = resampler_->ClampTimestamp(event.device, event.timestamp);
+      resampler_->Reset(event.device);
+      resampler_->AddSample(event);
+      break;
+    case kUp:
+    case kCancel:
+    case kRemove:
+      // The release carries the last position, so the moves still held back
+      // for this touch are dropped. It may not precede the last resampled
+      // move, which can be predicted past the last sample.
+      event.timestamp = resampler_->ClampTimestamp(event.device, event.timestamp);
+      resampler_->Reset(event.device);
+      break;
+    default:
+      break;
+    }
+    resampling_ = resampler_->HasActivePointers();
+
+    if (count_ == kCapacity)
+    {
+      Flush();
+    }
+    events_[count_++] = event;
+    Flush();
+  }
+
+  void PointerEventQueue::ResampleAndFlush(uint64_t frame_time_micros)
+  {
+    if (resampler_)
+    {
+      if (count_ + PointerResampler::kMaxDevices > kCapacity)
+      {
+        Flush();
+      }
+      count_ += resampler_->Resample(frame_time_micros, events_.data() + count_, kCapacity - count_);
+      resample_pending_ = false;
+    }
+    Flush();
+  }
+
+  void PointerEventQueue::Flush()
+  {
+    if (idle_enterer_)
+    {
+      ecore_idle_enterer_del(idle_enterer_);
+      idle_enterer_ = nullptr;
+    }
+    // Touch moves that have not been resampled yet still need a frame, or the
+    // timeout.
+    if (!resample_pending_)
+    {
+      if (vsync_timer_)
+      {
+        ecore_timer_del(vsync_timer_);
+        vsync_timer_ = nullptr;
+      }
+      waiting_for_vsync_ = false;
+    }
+
+    if (count_ == 0)
+    {
+      return;
+    }
+    if (FlutterEngineSendPointerEvent(engine_, events_.data(), count_) != kSuccess)
+    {
+      LogE("Could not send %zu pointer events.", count_);
+    }
+    count_ = 0;
+  }
+
+  // |VsyncWaiter::Observer|
+  void PointerEventQueue::OnVsync(uint64_t frame_start_time_nanos, uint64_t frame_target_time_nanos)
+  {
+    // Held touches are resampled every frame, as their resampled positions
+    // keep changing for a while after the last sample.
+    if (waiting_for_vsync_.exchange(false) || resampling_)
+    {
+      ecore_pipe_write(vsync_pipe_, &frame_start_time_nanos, sizeof(frame_start_time_nanos));
+    }
+  }
+
+  Eina_Bool PointerEventQueue::OnIdleEnterer(void *data)
+  {
+    auto *queue = reinterpret_cast<PointerEventQueue *>(data);
+    queue->idle_enterer_ = nullptr;
+    queue->Flush();
+    return ECORE_CALLBACK_CANCEL;
+  }
+
+  Eina_Bool PointerEventQueue::OnVsyncTimeout(void *data)
+  {
+    auto *queue = reinterpret_cast<PointerEventQueue *>(data);
+    queue->vsync_timer_ = nullptr;
+    queue->ResampleAndFlush(FlutterEngineGetCurrentTime() / 1000);
+    return ECORE_CALLBACK_CANCEL;
+  }
+
+  void PointerEventQueue::OnVsyncPipe(void *data, void *buffer, unsigned int size)
+  {
+    auto *queue = reinterpret_cast<PointerEventQueue *>(data);
+    uint64_t frame_start_time_nanos = 0;
+    if (size == sizeof(frame_start_time_nanos))
+    {
+      std::memcpy(&frame_start_time_nanos, buffer, size);
+      queue->ResampleAndFlush(frame_start_time_nanos / 1000);
+      return;
+    }
+    queue->Flush();
+  }
+
+} // namespace flutter
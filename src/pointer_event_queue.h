@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include <Ecore.h>
+
+#include "flutter_tizen.h"
+#include "pointer_resampler.h"
+#include "vsync_waiter.h"
+
+namespace flutter
+{
+  // Buffers pointer events and sends them to the engine in batches, with one
+  // engine call per batch instead of one per event. When a batch is sent is
+  // decided by the FlutterDesktopPointerBatching policy. Events are always sent
+  // in the order they were pushed, and consecutive scrolls of a pointer are
+  // sent as one, with every policy. With vsync batching, touch moves can
+  // instead be handed to a PointerResampler, and are then replaced by the
+  // positions at each frame's sample time. Must be used on the platform thread,
+  // except for OnVsync().
+  class PointerEventQueue : public VsyncWaiter::Observer
+  {
+  public:
+    // |resampler| is only used with vsync batching, and may be null.
+    PointerEventQueue(FlutterEngine engine, FlutterDesktopPointerBatching batching,
+                      std::unique_ptr<PointerResampler> resampler);
+    ~PointerEventQueue();
+    bool IsValid() const;
+
+    void Push(const FlutterPointerEvent &event);
+    void Flush();
+
+    // |VsyncWaiter::Observer|
+    void OnVsync(uint64_t frame_start_time_nanos, uint64_t frame_target_time_nanos) override;
+
+  private:
+    static constexpr size_t kCapacity = 64;
+    // How long moves wait for a vsync, which only comes while the engine is
+    // producing frames.
+    static constexpr double kVsyncTimeout = 1.0 / 60;
+
+    FlutterEngine engine_;
+    FlutterDesktopPointerBatching batching_;
+    bool valid_ = false;
+
+    std::array<FlutterPointerEvent, kCapacity> events_;
+    size_t count_ = 0;
+
+    std::unique_ptr<PointerResampler> resampler_;
+    // Set while touch moves have been added to the resampler since the last
+    // frame.
+    bool resample_pending_ = false;
+    // Set while a touch is down, and every vsync has to be resampled at.
+    std::atomic<bool> resampling_{false};
+
+    Ecore_Idle_Enterer *idle_enterer_ = nullptr;
+    Ecore_Timer *vsync_timer_ = nullptr;
+    // Wakes the platform thread up on vsync.
+    Ecore_Pipe *vsync_pipe_ = nullptr;
+    // Set while moves are held back for the next vsync.
+    std::atomic<bool> waiting_for_vsync_{false};
+
+    // Adds the deltas of a scroll to the previous event if that is a scroll of
+    // the same pointer, so that a fast wheel or bezel spin takes one event per
+    // batch.
+    bool MergeScroll(const FlutterPointerEvent &event);
+    // Appends the resampled touch moves and flushes.
+    void ResampleAndFlush(uint64_t frame_time_micros);
+    void PushTouch(FlutterPointerEvent event);
+
+    static Eina_Bool OnIdleEnterer(void *data);
+    static Eina_Bool OnVsyncTimeout(void *data);
+    static void OnVsyncPipe(void *data, void *buffer, unsigned int size);
+
+    // Disallow copy and assign operations.
+    PointerEventQueue(const PointerEventQueue &) = delete;
+    void operator=(const PointerEventQueue &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "pointer_resampler.h"
+
+#include <algorithm>
+
+namespace flutter
+{
+  PointerResampler::PointerResampler(int64_t prediction_micros) : prediction_micros_(prediction_micros) {}
+
+  void PointerResampler::AddSample(const FlutterPointerEvent &event)
+  {
+    if (event.device < 0 || static_cast<size_t>(event.device) >= kMaxDevices)
+    {
+      return;
+    }
+
+    History &history = histories_[event.device];
+    if (!history.active)
+    {
+      history.active = true;
+      history.count = 0;
+      history.last_x = event.x;
+      history.last_y = event.y;
+      active_count_++;
+    }
+
+    if (history.count == kHistorySize)
+    {
+      std::move(history.samples.begin() + 1, history.samples.end(), history.samples.begin());
+      history.count--;
+    }
+    history.samples[history.count++] = event;
+  }
+
+  void PointerResampler::Reset(int32_t device)
+  {
+    if (device < 0 || static_cast<size_t>(device) >= kMaxDevices || !histories_[device].active)
+    {
+      return;
+    }
+    histories_[device].active = false;
+    active_count_--;
+  }
+
+  bool PointerResampler::HasActivePointers() const { return active_count_ > 0; }
+
+  uint64_t PointerResampler::ClampTimestamp(int32_t device, uint64_t timestamp)
+  {
+    if (device < 0 || static_cast<size_t>(device) >= kMaxDevices)
+    {
+      return timestamp;
+    }
+    last_timestamps_[device] = std::max(last_timestamps_[device], timestamp);
+    return last_timestamps_[device];
+  }
+
+  size_t PointerResampler::Resample(uint64_t frame_time_micros, FlutterPointerEvent *events_out, size_t capacity)
+  {
+    uint64_t sample_time_micros = frame_time_micros + prediction_micros_;
+    size_t count = 0;
+    for (size_t device = 0; device < kMaxDevices; device++)
+    {
+      History &history = histories_[device];
+      if (!history.active || history.count == 0 || count == capacity)
+      {
+        continue;
+      }
+
+      const FlutterPointerEvent &last = history.samples[history.count - 1];
+      // The time the position is computed for, which is not predicted too far.
+      uint64_t time = std::min<uint64_t>(sample_time_micros, last.timestamp + kMaxPredictionMicros);
+      double x = last.x;
+      double y = last.y;
+      if (history.count > 1 && last.timestamp + kMaxSampleAgeMicros > sample_time_micros)
+      {
+        // Interpolate between the samples around the sample time, or
+        // extrapolate from the last two if it is past the last one.
+        size_t i = history.count - 1;
+        while (i > 1 && history.samples[i - 1].timestamp > time)
+        {
+          i--;
+        }
+        const FlutterPointerEvent &a = history.samples[i - 1];
+        const FlutterPointerEvent &b = history.samples[i];
+        if (b.timestamp > a.timestamp)
+        {
+          double t = (static_cast<double>(time) - a.timestamp) / (b.timestamp - a.timestamp);
+          // Never go back before the oldest sample.
+          t = std::max(t, 0.0);
+          x = a.x + (b.x - a.x) * t;
+          y = a.y + (b.y - a.y) * t;
+        }
+      }
+
+      if (x == history.last_x && y == history.last_y)
+      {
+        continue;
+      }
+      history.last_x = x;
+      history.last_y = y;
+
+      FlutterPointerEvent &event = events_out[count++];
+      event = last;
+      event.phase = kMove;
+      event.x = x;
+      event.y = y;
+      event.timestamp = ClampTimestamp(static_cast<int32_t>(device), time);
+    }
+    return count;
+  }
+
+} // namespace flutter
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <array>
+#include <cstdint>
+
+namespace flutter
+{
+  // Keeps the last few moves of each touch and produces, once per frame, the
+  // positions at the frame's sample time. Touch panels report at their own
+  // rate, unrelated to the display refresh, so forwarding raw samples moves
+  // the content by uneven steps from frame to frame. Device ids must be below
+  // kMaxDevices. Must be used on a single thread.
+  class PointerResampler
+  {
+  public:
+    static constexpr size_t kMaxDevices = 10;
+
+    // Positions are sampled |prediction_micros| after the frame start time,
+    // or before it if negative.
+    explicit PointerResampler(int64_t prediction_micros);
+
+    // Starts, continues or ends the history of |event.device|.
+    void AddSample(const FlutterPointerEvent &event);
+    void Reset(int32_t device);
+    bool HasActivePointers() const;
+
+    // Returns |timestamp|, or the last timestamp returned for |device| if that
+    // is later, so that the events of a touch never go back in time.
+    uint64_t ClampTimestamp(int32_t device, uint64_t timestamp);
+
+    // Writes a move for every touch whose position at the frame starting at
+    // |frame_time_micros| has changed, and returns the number of events
+    // written.
+    size_t Resample(uint64_t frame_time_micros, FlutterPointerEvent *events_out, size_t capacity);
+
+  private:
+    static constexpr size_t kHistorySize = 4;
+    // Positions are not predicted further than this past the last sample.
+    static constexpr uint64_t kMaxPredictionMicros = 8000;
+    // A touch that has not moved for this long is considered at rest.
+    static constexpr uint64_t kMaxSampleAgeMicros = 50000;
+
+    struct History
+    {
+      bool active;
+      // The last |count| samples, oldest first.
+      std::array<FlutterPointerEvent, kHistorySize> samples;
+      size_t count;
+      double last_x;
+      double last_y;
+    };
+
+    int64_t prediction_micros_;
+    std::array<History, kMaxDevices> histories_ = {};
+    // Kept across resets, since the release follows the last resampled move.
+    std::array<uint64_t, kMaxDevices> last_timestamps_ = {};
+    size_t active_count_ = 0;
+
+    // Disallow copy and assign operations.
+    PointerResampler(const PointerResampler &) = delete;
+    void operator=(const PointerResampler &) = delete;
+  };
+
+} // namespace flutter
@@ -17,6 +17,7 @@
 #ifndef FLUTTER_SHELL_PLATFORM_TIZEN_PUBLIC_FLUTTER_H_
 #define FLUTTER_SHELL_PLATFORM_TIZEN_PUBLIC_FLUTTER_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -27,6 +28,8 @@ extern "C"
 {
 #endif
 
+  struct wl_surface;
+
   typedef struct FlutterApplicationState* FlutterApplicationRef;
 
   // Properties representing a generic rectangular size.
@@ -36,6 +39,64 @@ extern "C"
     int32_t height;
   } FlutterDesktopSize;
 
+  // The source of vsync events used to pace frames.
+  typedef enum
+  {
+    // Use the first available one of the sources below, in order.
+    kFlutterDesktopVsyncSourceAuto,
+    // Vblank events from the Tizen Display Manager.
+    kFlutterDesktopVsyncSourceTdm,
+    // wl_surface frame callbacks of the application window.
+    kFlutterDesktopVsyncSourceWaylandFrame,
+    // A software timer running at |vsync_timer_rate|.
+    kFlutterDesktopVsyncSourceTimer,
+  } FlutterDesktopVsyncSource;
+
+  // How frames are rendered.
+  typedef enum
+  {
+    // Rendered and composited with OpenGL ES through EGL.
+    kFlutterDesktopRendererOpenGL,
+    // Rendered on the CPU and presented through wl_shm buffers. Platform views
+    // and external textures are not supported.
+    kFlutterDesktopRendererSoftware,
+  } FlutterDesktopRenderer;
+
+  // The pixel format of the buffers presented by the software renderer.
+  typedef enum
+  {
+    kFlutterDesktopPixelFormatXRGB8888,
+    // Halves memory bandwidth at the cost of color depth.
+    kFlutterDesktopPixelFormatRGB565,
+  } FlutterDesktopPixelFormat;
+
+  // The pixel format of the window surface of the OpenGL renderer.
+  typedef enum
+  {
+    kFlutterDesktopSurfaceFormatRGBA8888,
+    // Opaque formats. Platform views cannot be shown, as they need the window
+    // to be transparent where they are placed.
+    kFlutterDesktopSurfaceFormatRGB888,
+    // Halves the scanout bandwidth at the cost of color depth.
+    kFlutterDesktopSurfaceFormatRGB565,
+  } FlutterDesktopSurfaceFormat;
+
+  // When buffered pointer events are sent to the engine. Presses and releases
+  // are never reordered with moves. Wheel and bezel scrolls count as moves,
+  // and the consecutive scrolls of a batch are sent as one. Without batching,
+  // scrolls are still batched per main loop iteration.
+  typedef enum
+  {
+    // Send every event as it arrives.
+    kFlutterDesktopPointerBatchingImmediate,
+    // Send the events of an ecore main loop iteration together, once it has
+    // dispatched all of them.
+    kFlutterDesktopPointerBatchingIteration,
+    // Send moves when the next frame starts, and presses and releases as they
+    // arrive. Moves wait at most a frame period while no frames are produced.
+    kFlutterDesktopPointerBatchingVsync,
+  } FlutterDesktopPointerBatching;
+
   // Properties for configuring a Flutter engine instance.
   typedef struct
   {
@@ -47,8 +108,116 @@ extern "C"
     // This can either be an absolute path or a path relative to the directory
     // containing the executable.
     const char *icu_data_path;
+    // The source of vsync events.
+    FlutterDesktopVsyncSource vsync_source;
+    // The tick rate in Hz of the software vsync timer. Defaults to 60 if zero.
+    double vsync_timer_rate;
+    // The offset in microseconds of the reported frame start relative to the
+    // vblank. Negative values wake the engine before the vblank, trading
+    // latency for a longer frame budget.
+    int32_t vsync_phase_offset;
+    // Derive the phase offset from measured frame durations instead, starting
+    // each frame as late as it can afford to. Overrides |vsync_phase_offset|.
+    bool vsync_adaptive_phase;
+    // The name of the render (raster) thread. Defaults to "flutter-raster" if
+    // null. Truncated to 15 characters.
+    const char *render_thread_name;
+    // The SCHED_FIFO priority (1-99) of the render thread, or 0 to keep the
+    // default scheduling policy.
+    int32_t render_thread_priority;
+    // The nice value of the render thread. Ignored if |render_thread_priority|
+    // is set.
+    int32_t render_thread_nice;
+    // The CPUs the render thread may run on, as a bit mask (bit N for CPU N),
+    // for example to keep it on the big cores. 0 allows any CPU.
+    uint64_t render_thread_cpu_mask;
+    // The renderer, and for the software renderer the format of the presented
+    // buffers.
+    FlutterDesktopRenderer renderer;
+    FlutterDesktopPixelFormat software_pixel_format;
+    // The window surface of the OpenGL renderer. The depth and stencil sizes
+    // are minimums, in bits.
+    FlutterDesktopSurfaceFormat surface_format;
+    int32_t surface_depth_bits;
+    int32_t surface_stencil_bits;
+    // Dynamic resolution for the OpenGL renderer. While rasterizing a frame
+    // keeps taking longer than |render_scale_frame_budget| microseconds, the
+    // engine renders at a lower resolution, down to |render_scale_min| times
+    // the window size, and the result is stretched to the window. The full
+    // resolution comes back once there is headroom. Disabled if
+    // |render_scale_min| is 0 or at least 1. The budget defaults to 13 ms.
+    double render_scale_min;
+    int32_t render_scale_frame_budget;
+    FlutterDesktopPointerBatching pointer_batching;
+    // With vsync batching, send touch moves at each frame's start time plus
+    // |touch_prediction| microseconds, interpolated between the reported
+    // positions, or extrapolated from the last two by at most 8 ms. A negative
+    // prediction trades latency for positions that are never guessed.
+    bool touch_resampling;
+    int32_t touch_prediction;
   } FlutterDesktopEngineProperties;
 
+  // Counters describing the work done by the renderer since the application
+  // started.
+  typedef struct
+  {
+    // The number of eglMakeCurrent calls made.
+    uint64_t make_current_count;
+    // The number of context bind or unbind requests from the engine that were
+    // skipped because the requested binding was already current.
+    uint64_t make_current_skipped_count;
+    // The number of frames presented with a damage region smaller than the
+    // window, and with the whole window damaged.
+    uint64_t partial_present_count;
+    uint64_t full_present_count;
+    // The GPU memory held by compositor backing stores, of which
+    // |backing_store_pooled_bytes| is unused and kept for reuse.
+    uint64_t backing_store_bytes;
+    uint64_t backing_store_pooled_bytes;
+    // The number of backing store allocations made. Stays constant once the
+    // pool has warmed up.
+    uint64_t backing_store_allocation_count;
+    // The number of GL functions requested by the engine, of which
+    // |gl_proc_resolved_count| were not cached yet, and the time spent
+    // resolving those. Almost all of them are requested at startup.
+    uint64_t gl_proc_lookup_count;
+    uint64_t gl_proc_resolved_count;
+    uint64_t gl_proc_resolve_time_nanos;
+  } FlutterDesktopRenderStats;
+
+  typedef struct FlutterDesktopExternalTextureState* FlutterDesktopExternalTextureRef;
+
+  // The kind of buffer an external texture frame is imported from.
+  typedef enum
+  {
+    // A tbm_surface_h, imported through EGL_TIZEN_image_native_surface.
+    kFlutterDesktopExternalBufferTbmSurface,
+    // Linux dma-buf planes, imported through EGL_EXT_image_dma_buf_import.
+    kFlutterDesktopExternalBufferDmaBuf,
+  } FlutterDesktopExternalBufferType;
+
+  // A frame of an external texture. The buffer is read by the GPU in place and
+  // must not be written to until |release_callback| is called.
+  typedef struct
+  {
+    FlutterDesktopExternalBufferType type;
+    int32_t width;
+    int32_t height;
+    // The tbm_surface_h, for kFlutterDesktopExternalBufferTbmSurface.
+    void *tbm_surface;
+    // The DRM fourcc format and planes, for kFlutterDesktopExternalBufferDmaBuf.
+    // The fds are not closed by the embedder.
+    uint32_t drm_format;
+    uint32_t plane_count;
+    int32_t plane_fds[3];
+    uint32_t plane_offsets[3];
+    uint32_t plane_strides[3];
+    // Called, on any thread, once the buffer is no longer used. Frames that
+    // are replaced before being drawn are released as well.
+    void (*release_callback)(void *user_data);
+    void *release_user_data;
+  } FlutterDesktopExternalBuffer;
+
   FLUTTER_EXPORT FlutterApplicationRef RunFlutterApplication(
       const FlutterDesktopSize &size,
       const FlutterDesktopEngineProperties &engine_properties,
@@ -64,8 +233,98 @@ extern "C"
       // The number of elements in |switches|.
       size_t switches_count);
 
+  // Where an offscreen application writes its frames.
+  typedef struct
+  {
+    // Receives each frame as RGBA8888 rows, top row first. Must be at least
+    // |row_bytes| times the height of the application.
+    void *buffer;
+    size_t row_bytes;
+    // Called on the render thread once |buffer| holds the frame
+    // |frame_number|, counting from 0. |buffer| is overwritten by the next
+    // frame after the callback returns.
+    void (*frame_callback)(void *user_data, uint64_t frame_number);
+    void *user_data;
+  } FlutterDesktopOffscreenTarget;
+
+  // Runs an application without a window, rendering each frame into |target|,
+  // for example to generate images or video in batch. Frames are paced by the
+  // vsync timer at |engine_properties.vsync_timer_rate|, always at full
+  // resolution, and the renderer and surface properties are ignored. Platform
+  // views and external textures are not supported.
+  FLUTTER_EXPORT FlutterApplicationRef RunFlutterApplicationOffscreen(
+      const FlutterDesktopSize &size,
+      const FlutterDesktopEngineProperties &engine_properties,
+      const FlutterDesktopOffscreenTarget &target,
+      const char **switches,
+      size_t switches_count);
+
+  // Frames are read back from the GPU a few frames behind rendering. Delivers
+  // every frame rendered so far to the target, for example after the last
+  // frame of a batch, and returns once they have been delivered. Must not be
+  // called from the frame callback.
+  FLUTTER_EXPORT bool FlushFlutterApplicationOffscreenFrames(FlutterApplicationRef application);
+
   FLUTTER_EXPORT bool StopFlutterApplication(FlutterApplicationRef application);
 
+  // Notifies the application that it is visible and has input focus.
+  FLUTTER_EXPORT bool ResumeFlutterApplication(FlutterApplicationRef application);
+
+  // Notifies the application that it is visible but does not have input focus.
+  FLUTTER_EXPORT bool InactivateFlutterApplication(FlutterApplicationRef application);
+
+  // Notifies the application that it is no longer visible. No frames are
+  // requested or presented until ResumeFlutterApplication() is called.
+  FLUTTER_EXPORT bool PauseFlutterApplication(FlutterApplicationRef application);
+
+  // Rotates the application clockwise by |degrees|, which must be 0, 90, 180
+  // or 270. The window keeps its size. The content is rendered rotated and the
+  // display server rotates the window at scanout, so the app only lays out
+  // again when its aspect ratio changes. Only supported by the OpenGL renderer.
+  FLUTTER_EXPORT bool SetFlutterApplicationRotation(FlutterApplicationRef application, int32_t degrees);
+
+  // Lets the window manager rotate the application to any of |degrees|, for
+  // example following the device orientation. Only supported by the OpenGL
+  // renderer.
+  FLUTTER_EXPORT bool SetFlutterApplicationAvailableRotations(FlutterApplicationRef application,
+                                                              const int32_t *degrees,
+                                                              size_t count);
+
+  // Fills |stats| with the current renderer counters. Can be called from any
+  // thread.
+  FLUTTER_EXPORT bool GetFlutterApplicationRenderStats(FlutterApplicationRef application,
+                                                       FlutterDesktopRenderStats *stats);
+
+  // Creates a surface that is shown wherever the Flutter app places the
+  // platform view |view_id| (see SceneBuilder.addPlatformView), below the
+  // Flutter content. Native content such as video should be presented to the
+  // returned surface at the size of the view. Must be called on the main
+  // thread.
+  FLUTTER_EXPORT struct wl_surface *CreateFlutterPlatformViewSurface(FlutterApplicationRef application,
+                                                                     int64_t view_id);
+
+  FLUTTER_EXPORT bool DestroyFlutterPlatformViewSurface(FlutterApplicationRef application,
+                                                        int64_t view_id);
+
+  // Registers a texture whose frames are produced outside of Flutter, for
+  // example by a camera or a video decoder. Frames are shown by a Texture
+  // widget with the id returned by GetFlutterExternalTextureId().
+  FLUTTER_EXPORT FlutterDesktopExternalTextureRef RegisterFlutterExternalTexture(FlutterApplicationRef application);
+
+  FLUTTER_EXPORT int64_t GetFlutterExternalTextureId(FlutterDesktopExternalTextureRef texture);
+
+  // Makes |buffer| the next frame of |texture|. Never blocks on rendering, so
+  // it can be called from the producer's own thread, but not concurrently for
+  // the same texture.
+  FLUTTER_EXPORT bool PushFlutterExternalTextureBuffer(FlutterApplicationRef application,
+                                                       FlutterDesktopExternalTextureRef texture,
+                                                       const FlutterDesktopExternalBuffer *buffer);
+
+  // Unregisters |texture|. Its pending buffers are released once rendering is
+  // done with them. |texture| must not be used afterwards.
+  FLUTTER_EXPORT bool UnregisterFlutterExternalTexture(FlutterApplicationRef application,
+                                                       FlutterDesktopExternalTextureRef texture);
+
 #if defined(__cplusplus)
 } // extern "C"
 #endif
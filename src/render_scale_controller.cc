@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "render_scale_controller.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+namespace flutter
+{
+  // Bound to a const reference by std::max, so it needs a definition in C++14.
+  constexpr double RenderScaleController::kScaleStep;
+
+  RenderScaleController::RenderScaleController(double min_scale, uint64_t frame_budget_nanos)
+      : min_scale_(std::min(std::max(min_scale, kScaleStep), 1.0)), frame_budget_nanos_(frame_budget_nanos)
+  {
+  }
+
+  bool RenderScaleController::OnFrameRasterized(uint64_t raster_time_nanos)
+  {
+    if (settle_count_ > 0)
+    {
+      settle_count_--;
+      return false;
+    }
+
+    if (raster_time_nanos > frame_budget_nanos_)
+    {
+      over_budget_count_++;
+      headroom_count_ = 0;
+    }
+    else if (raster_time_nanos < frame_budget_nanos_ * kHeadroom)
+    {
+      headroom_count_++;
+      over_budget_count_ = 0;
+    }
+    else
+    {
+      over_budget_count_ = 0;
+      headroom_count_ = 0;
+    }
+
+    double scale = scale_;
+    double new_scale = scale;
+    if (over_budget_count_ >= kDownscaleFrames)
+    {
+      new_scale = std::max(scale - kScaleStep, min_scale_);
+    }
+    else if (headroom_count_ >= kUpscaleFrames)
+    {
+      new_scale = std::min(scale + kScaleStep, 1.0);
+    }
+    else
+    {
+      return false;
+    }
+
+    over_budget_count_ = 0;
+    headroom_count_ = 0;
+    if (new_scale == scale)
+    {
+      return false;
+    }
+
+    LogD("Changing the render scale from %.3f to %.3f.", scale, new_scale);
+    scale_ = new_scale;
+    settle_count_ = kSettleFrames;
+    return true;
+  }
+
+  double RenderScaleController::GetScale() const { return scale_; }
+
+} // namespace flutter
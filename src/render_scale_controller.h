@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace flutter
+{
+  // Picks the resolution the engine renders at, as a fraction of the window
+  // size, from the measured raster times. The scale goes down as soon as
+  // rasterizing keeps exceeding the frame budget, and back up slowly once there
+  // is enough headroom, so that heavy animations lose sharpness rather than
+  // frames.
+  class RenderScaleController
+  {
+  public:
+    RenderScaleController(double min_scale, uint64_t frame_budget_nanos);
+
+    // Called on the render thread for every rasterized frame. Returns true if
+    // the scale has changed.
+    bool OnFrameRasterized(uint64_t raster_time_nanos);
+    // Can be called on any thread.
+    double GetScale() const;
+
+  private:
+    static constexpr double kScaleStep = 0.125;
+    // Raster times below this share of the budget count as headroom.
+    static constexpr double kHeadroom = 0.6;
+    // Frames in a row needed before scaling down or up.
+    static constexpr int kDownscaleFrames = 3;
+    static constexpr int kUpscaleFrames = 60;
+    // Frames ignored after a change, while the engine switches to the new size.
+    static constexpr int kSettleFrames = 10;
+
+    const double min_scale_;
+    const uint64_t frame_budget_nanos_;
+    std::atomic<double> scale_{1.0};
+
+    // Only accessed on the render thread.
+    int over_budget_count_ = 0;
+    int headroom_count_ = 0;
+    int settle_count_ = 0;
+  };
+
+} // namespace flutter
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "render_task_runner.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "logger.h"
+
+namespace flutter
+{
+  // Thread names are limited to 16 bytes including the terminator.
+  static constexpr size_t kMaxThreadNameLength = 15;
+
+  RenderTaskRunner::RenderTaskRunner(const std::string &name, int realtime_priority, int nice, uint64_t cpu_mask)
+      : TaskRunner(kIdentifier),
+        name_(name.substr(0, kMaxThreadNameLength)),
+        realtime_priority_(realtime_priority),
+        nice_(nice),
+        cpu_mask_(cpu_mask)
+  {
+    if (!TaskRunner::IsValid())
+    {
+      return;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_fd_ < 0)
+    {
+      LogE("Could not create the render task runner eventfd.");
+      return;
+    }
+
+    thread_ = std::thread(&RenderTaskRunner::ThreadMain, this);
+    thread_id_ = thread_.get_id();
+  }
+
+  RenderTaskRunner::~RenderTaskRunner()
+  {
+    if (thread_.joinable())
+    {
+      running_ = false;
+      uint64_t value = 1;
+      if (write(wakeup_fd_, &value, sizeof(value)) < 0)
+      {
+        LogE("Could not wake up the render thread.");
+      }
+      thread_.join();
+    }
+
+    if (wakeup_fd_ >= 0)
+    {
+      close(wakeup_fd_);
+      wakeup_fd_ = -1;
+    }
+  }
+
+  bool RenderTaskRunner::IsValid() const { return TaskRunner::IsValid() && thread_.joinable(); }
+
+  void RenderTaskRunner::ThreadMain()
+  {
+    ApplyThreadSettings();
+
+    pollfd fds[2] = {};
+    fds[0].fd = timer_fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = wakeup_fd_;
+    fds[1].events = POLLIN;
+
+    while (running_)
+    {
+      if (poll(fds, 2, -1) < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        LogE("Could not poll the render task runner: %s", strerror(errno));
+        break;
+      }
+
+      if (fds[0].revents & POLLIN)
+      {
+        RunExpiredTasks();
+      }
+    }
+  }
+
+  void RenderTaskRunner::ApplyThreadSettings()
+  {
+    if (!name_.empty() && pthread_setname_np(pthread_self(), name_.c_str()) != 0)
+    {
+      LogW("Could not set the render thread name.");
+    }
+
+    if (realtime_priority_ > 0)
+    {
+      sched_param param = {};
+      param.sched_priority = realtime_priority_;
+      int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+      if (error != 0)
+      {
+        LogW("Could not set SCHED_FIFO priority %d on the render thread: %s", realtime_priority_, strerror(error));
+      }
+    }
+    else if (nice_ != 0)
+    {
+      // On Linux the nice value is a per-thread attribute.
+      pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+      if (setpriority(PRIO_PROCESS, tid, nice_) != 0)
+      {
+        LogW("Could not set nice %d on the render thread: %s", nice_, strerror(errno));
+      }
+    }
+
+    if (cpu_mask_ != 0)
+    {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      for (int cpu = 0; cpu < 64; cpu++)
+      {
+        if (cpu_mask_ & (1ull << cpu))
+        {
+          CPU_SET(cpu, &cpus);
+        }
+      }
+      int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+      if (error != 0)
+      {
+        LogW("Could not set the render thread affinity: %s", strerror(error));
+      }
+    }
+  }
+
+} // namespace flutter
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "task_runner.h"
+
+namespace flutter
+{
+  // Runs raster tasks, and with them all of the onscreen EGL callbacks, on a
+  // thread owned by the embedder so that its scheduling can be controlled.
+  class RenderTaskRunner : public TaskRunner
+  {
+  public:
+    // A |realtime_priority| between 1 and 99 runs the thread under SCHED_FIFO,
+    // otherwise |nice| is applied. A zero |cpu_mask| leaves the affinity
+    // unchanged; bit N allows the thread on CPU N.
+    RenderTaskRunner(const std::string &name, int realtime_priority, int nice, uint64_t cpu_mask);
+    virtual ~RenderTaskRunner();
+    // Also requires the render thread to be running.
+    bool IsValid() const override;
+
+  private:
+    static constexpr size_t kIdentifier = 2;
+
+    std::string name_;
+    int realtime_priority_;
+    int nice_;
+    uint64_t cpu_mask_;
+
+    int wakeup_fd_ = -1;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+
+    void ThreadMain();
+    void ApplyThreadSettings();
+  };
+
+} // namespace flutter
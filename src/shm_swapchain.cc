@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "shm_swapchain.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "logger.h"
+#include "pixel_rows.h"
+
+namespace flutter
+{
+  const wl_buffer_listener ShmSwapchain::kBufferListener = {
+      ShmSwapchain::OnBufferRelease,
+  };
+
+  // Creates an unlinked file to back the shared memory pool.
+  static int CreateAnonymousFile(size_t size)
+  {
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    std::string path = std::string(runtime_dir ? runtime_dir : "/tmp") + "/flutter-shm-XXXXXX";
+
+    int fd = mkostemp(&path[0], O_CLOEXEC);
+    if (fd < 0)
+    {
+      return -1;
+    }
+    unlink(path.c_str());
+
+    if (ftruncate(fd, size) < 0)
+    {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  ShmSwapchain::ShmSwapchain(wl_display *display, wl_shm *shm, wl_surface *surface,
+                             int32_t width, int32_t height, uint32_t format)
+      : display_(display), width_(width), height_(height), format_(format)
+  {
+    if (!display || !shm || !surface)
+    {
+      LogE("Invalid arguments for the wl_shm swapchain.");
+      return;
+    }
+
+    int32_t bytes_per_pixel = format_ == WL_SHM_FORMAT_RGB565 ? 2 : 4;
+    stride_ = width_ * bytes_per_pixel;
+    size_t buffer_size = static_cast<size_t>(stride_) * height_;
+    size_ = buffer_size * kBufferCount;
+    row_.resize(stride_);
+
+    fd_ = CreateAnonymousFile(size_);
+    if (fd_ < 0)
+    {
+      LogE("Could not create the wl_shm swapchain memory.");
+      return;
+    }
+
+    data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data_ == MAP_FAILED)
+    {
+      data_ = nullptr;
+      LogE("Could not map the wl_shm swapchain memory.");
+      return;
+    }
+
+    // Objects created through the wrappers deliver their events to |queue_|.
+    queue_ = wl_display_create_queue(display_);
+    auto *shm_wrapper = static_cast<wl_shm *>(wl_proxy_create_wrapper(shm));
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(shm_wrapper), queue_);
+    surface_ = static_cast<wl_surface *>(wl_proxy_create_wrapper(surface));
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(surface_), queue_);
+
+    wl_shm_pool *pool = wl_shm_create_pool(shm_wrapper, fd_, static_cast<int32_t>(size_));
+    for (size_t i = 0; i < kBufferCount; i++)
+    {
+      Buffer &buffer = buffers_[i];
+      buffer.swapchain = this;
+      buffer.data = static_cast<uint8_t *>(data_) + buffer_size * i;
+      buffer.dirty_first = 0;
+      buffer.dirty_last = height_ - 1;
+      buffer.buffer = wl_shm_pool_create_buffer(pool, static_cast<int32_t>(buffer_size * i),
+                                                width_, height_, stride_, format_);
+      wl_buffer_add_listener(buffer.buffer, &kBufferListener, &buffer);
+    }
+    wl_shm_pool_destroy(pool);
+    wl_proxy_wrapper_destroy(shm_wrapper);
+
+    valid_ = true;
+  }
+
+  ShmSwapchain::~ShmSwapchain()
+  {
+    for (Buffer &buffer : buffers_)
+    {
+      if (buffer.buffer)
+      {
+        wl_buffer_destroy(buffer.buffer);
+        buffer.buffer = nullptr;
+      }
+    }
+
+    if (surface_)
+    {
+      wl_proxy_wrapper_destroy(surface_);
+      surface_ = nullptr;
+    }
+
+    if (queue_)
+    {
+      wl_event_queue_destroy(queue_);
+      queue_ = nullptr;
+    }
+
+    if (data_)
+    {
+      munmap(data_, size_);
+      data_ = nullptr;
+    }
+
+    if (fd_ >= 0)
+    {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  bool ShmSwapchain::IsValid() const { return valid_; }
+
+  bool ShmSwapchain::Present(const void *allocation, size_t row_bytes, size_t height)
+  {
+    Buffer *buffer = AcquireBuffer();
+    if (!buffer)
+    {
+      // The frame may be the last one for a while, so it must not be lost.
+      // The engine's allocation is only valid during the call.
+      LogD("No free wl_shm buffer, holding the frame back.");
+      held_frame_.resize(row_bytes * height);
+      memcpy(held_frame_.data(), allocation, held_frame_.size());
+      held_row_bytes_ = row_bytes;
+      held_height_ = height;
+      frame_held_ = true;
+      return false;
+    }
+
+    frame_held_ = false;
+    PresentInto(buffer, allocation, row_bytes, height);
+    return true;
+  }
+
+  bool ShmSwapchain::PresentHeldFrame()
+  {
+    if (!frame_held_)
+    {
+      return true;
+    }
+    Buffer *buffer = AcquireBuffer();
+    if (!buffer)
+    {
+      return false;
+    }
+    frame_held_ = false;
+    PresentInto(buffer, held_frame_.data(), held_row_bytes_, held_height_);
+    return true;
+  }
+
+  void ShmSwapchain::PresentInto(Buffer *buffer, const void *allocation, size_t row_bytes, size_t height)
+  {
+    int32_t rows = std::min(static_cast<int32_t>(height), height_);
+    size_t pixels = std::min(row_bytes / 4, static_cast<size_t>(width_));
+    size_t copy_bytes = format_ == WL_SHM_FORMAT_RGB565 ? pixels * 2 : pixels * 4;
+
+    int32_t first_damaged = -1;
+    int32_t last_damaged = -1;
+    for (int32_t y = 0; y < rows; y++)
+    {
+      const auto *src = static_cast<const uint8_t *>(allocation) + row_bytes * y;
+      size_t offset = static_cast<size_t>(stride_) * y;
+
+      if (format_ == WL_SHM_FORMAT_RGB565)
+      {
+        ConvertRowToRGB565(reinterpret_cast<uint16_t *>(row_.data()), reinterpret_cast<const uint32_t *>(src), pixels);
+        src = row_.data();
+      }
+
+      bool damaged = !last_presented_ || memcmp(last_presented_->data + offset, src, copy_bytes) != 0;
+      if (damaged)
+      {
+        if (first_damaged < 0)
+        {
+          first_damaged = y;
+        }
+        last_damaged = y;
+      }
+
+      // Rows that changed while this buffer was with the display server are
+      // stale even if the last frame did not change them.
+      if (damaged || (y >= buffer->dirty_first && y <= buffer->dirty_last))
+      {
+        CopyRow(buffer->data + offset, src, copy_bytes);
+      }
+    }
+
+    buffer->dirty_first = -1;
+    buffer->dirty_last = -1;
+    if (first_damaged >= 0)
+    {
+      for (Buffer &other : buffers_)
+      {
+        if (&other == buffer)
+        {
+          continue;
+        }
+        other.dirty_first = other.dirty_first < 0 ? first_damaged : std::min(other.dirty_first, first_damaged);
+        other.dirty_last = std::max(other.dirty_last, last_damaged);
+      }
+    }
+    last_presented_ = buffer;
+
+    wl_surface_attach(surface_, buffer->buffer, 0, 0);
+    if (first_damaged >= 0)
+    {
+      wl_surface_damage_buffer(surface_, 0, first_damaged, width_, last_damaged - first_damaged + 1);
+    }
+    wl_surface_commit(surface_);
+    buffer->busy = true;
+    wl_display_flush(display_);
+  }
+
+  ShmSwapchain::Buffer *ShmSwapchain::AcquireBuffer()
+  {
+    // Run the release events read by the main loop.
+    wl_display_dispatch_queue_pending(display_, queue_);
+
+    for (size_t i = 0; i < kBufferCount; i++)
+    {
+      Buffer &buffer = buffers_[(next_buffer_ + i) % kBufferCount];
+      if (!buffer.busy)
+      {
+        next_buffer_ = (next_buffer_ + i + 1) % kBufferCount;
+        return &buffer;
+      }
+    }
+    return nullptr;
+  }
+
+  void ShmSwapchain::OnBufferRelease(void *data, wl_buffer *buffer)
+  {
+    reinterpret_cast<Buffer *>(data)->busy = false;
+  }
+
+} // namespace flutter
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <wayland-client.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter
+{
+  // Presents software-rendered frames to a surface through a ring of wl_shm
+  // buffers. Rows are compared with the last presented buffer, and only the
+  // ones that changed are damaged and, together with the rows that changed
+  // since a buffer was last written, copied. Buffer releases are
+  // dispatched on a private queue, so Present() can be called from the render
+  // thread.
+  class ShmSwapchain
+  {
+  public:
+    // |format| is WL_SHM_FORMAT_XRGB8888, WL_SHM_FORMAT_ARGB8888 or
+    // WL_SHM_FORMAT_RGB565.
+    ShmSwapchain(wl_display *display, wl_shm *shm, wl_surface *surface,
+                 int32_t width, int32_t height, uint32_t format);
+    ~ShmSwapchain();
+    bool IsValid() const;
+
+    // Copies a frame in the engine's BGRA8888 order into the next free buffer
+    // and commits it. Returns false if no buffer is free, in which case a copy
+    // of the frame is held back until PresentHeldFrame() finds one.
+    bool Present(const void *allocation, size_t row_bytes, size_t height);
+    // Presents the held back frame if a buffer has been released since.
+    // Returns false while a frame is still held back.
+    bool PresentHeldFrame();
+
+  private:
+    struct Buffer
+    {
+      ShmSwapchain *swapchain;
+      wl_buffer *buffer;
+      uint8_t *data;
+      bool busy;
+      // Rows that changed since this buffer was last written, or -1.
+      int32_t dirty_first;
+      int32_t dirty_last;
+    };
+
+    static constexpr size_t kBufferCount = 3;
+
+    wl_display *display_;
+    wl_event_queue *queue_ = nullptr;
+    wl_surface *surface_ = nullptr;
+    int32_t width_;
+    int32_t height_;
+    uint32_t format_;
+    int32_t stride_ = 0;
+
+    int fd_ = -1;
+    void *data_ = nullptr;
+    size_t size_ = 0;
+    Buffer buffers_[kBufferCount] = {};
+    size_t next_buffer_ = 0;
+    Buffer *last_presented_ = nullptr;
+    // One converted row, compared with the buffer before it is written.
+    std::vector<uint8_t> row_;
+    // The latest frame that found no free buffer, replaced by the next one.
+    std::vector<uint8_t> held_frame_;
+    size_t held_row_bytes_ = 0;
+    size_t held_height_ = 0;
+    bool frame_held_ = false;
+
+    bool valid_ = false;
+
+    Buffer *AcquireBuffer();
+    void PresentInto(Buffer *buffer, const void *allocation, size_t row_bytes, size_t height);
+    static void OnBufferRelease(void *data, wl_buffer *buffer);
+    static const wl_buffer_listener kBufferListener;
+
+    // Disallow copy and assign operations.
+    ShmSwapchain(const ShmSwapchain &) = delete;
+    void operator=(const ShmSwapchain &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "task_runner.h"
+
+#include <errno.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace flutter
+{
+  TaskRunner::TaskRunner(size_t identifier)
+  {
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer_fd_ < 0)
+    {
+      LogE("Could not create the task runner timerfd.");
+    }
+
+    expired_tasks_.reserve(16);
+
+    description_.struct_size = sizeof(FlutterTaskRunnerDescription);
+    description_.user_data = this;
+    description_.identifier = identifier;
+    description_.runs_task_on_current_thread_callback = [](void *data) -> bool {
+      return reinterpret_cast<TaskRunner *>(data)->RunsTasksOnCurrentThread();
+    };
+    description_.post_task_callback = [](FlutterTask task, uint64_t target_time_nanos, void *data) -> void {
+      reinterpret_cast<TaskRunner *>(data)->PostTask(task, target_time_nanos);
+    };
+  }
+
+  TaskRunner::~TaskRunner()
+  {
+    if (timer_fd_ >= 0)
+    {
+      close(timer_fd_);
+      timer_fd_ = -1;
+    }
+  }
+
+  bool TaskRunner::IsValid() const { return timer_fd_ >= 0; }
+
+  const FlutterTaskRunnerDescription *TaskRunner::GetDescription() const { return &description_; }
+
+  void TaskRunner::SetEngine(FlutterEngine engine) { engine_ = engine; }
+
+  uint64_t TaskRunner::GetCurrentTaskStartTime() const { return current_task_start_nanos_; }
+
+  bool TaskRunner::RunsTasksOnCurrentThread() const
+  {
+    return std::this_thread::get_id() == thread_id_;
+  }
+
+  void TaskRunner::PostTask(FlutterTask task, uint64_t target_time_nanos)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint64_t order = task_order_++;
+    tasks_.push({order, target_time_nanos, task});
+
+    // Only a new earliest task moves the wakeup.
+    if (tasks_.top().order == order)
+    {
+      ArmTimer(target_time_nanos);
+    }
+  }
+
+  void TaskRunner::RunExpiredTasks()
+  {
+    uint64_t expirations;
+    if (read(timer_fd_, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+    {
+      LogW("Could not read the task runner timerfd.");
+    }
+
+    FlutterEngine engine = engine_;
+    if (engine)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t now = FlutterEngineGetCurrentTime();
+        while (!tasks_.empty() && tasks_.top().target_time <= now)
+        {
+          expired_tasks_.push_back(tasks_.top().task);
+          tasks_.pop();
+        }
+      }
+
+      // Tasks may post new tasks, so they are run without holding the lock.
+      for (const FlutterTask &task : expired_tasks_)
+      {
+        current_task_start_nanos_ = FlutterEngineGetCurrentTime();
+        if (FlutterEngineRunTask(engine, &task) != kSuccess)
+        {
+          LogE("Could not run an engine task.");
+        }
+      }
+      expired_tasks_.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!tasks_.empty())
+    {
+      ArmTimer(tasks_.top().target_time);
+    }
+  }
+
+  void TaskRunner::ArmTimer(uint64_t target_time_nanos)
+  {
+    // A zero expiration would disarm the timer rather than fire it.
+    if (target_time_nanos == 0)
+    {
+      target_time_nanos = 1;
+    }
+
+    itimerspec spec = {};
+    spec.it_value.tv_sec = target_time_nanos / 1000000000ull;
+    spec.it_value.tv_nsec = target_time_nanos % 1000000000ull;
+    if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0)
+    {
+      LogE("Could not arm the task runner timerfd.");
+    }
+  }
+
+} // namespace flutter
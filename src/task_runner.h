@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace flutter
+{
+  // Runs engine tasks at their target times on a single thread. Pending tasks
+  // are kept in a min-heap keyed by target time, and the thread is woken up
+  // through one timerfd armed for the earliest of them. Subclasses decide which
+  // thread waits on the timerfd and call RunExpiredTasks() when it fires.
+  class TaskRunner
+  {
+  public:
+    virtual ~TaskRunner();
+    virtual bool IsValid() const;
+    const FlutterTaskRunnerDescription *GetDescription() const;
+    void SetEngine(FlutterEngine engine);
+    // When the task being run started. Only meaningful on the runner thread,
+    // from within a task.
+    uint64_t GetCurrentTaskStartTime() const;
+
+  protected:
+    explicit TaskRunner(size_t identifier);
+
+    // Must be called on the runner thread when |timer_fd_| becomes readable.
+    void RunExpiredTasks();
+
+    int timer_fd_ = -1;
+    std::thread::id thread_id_;
+
+  private:
+    struct Task
+    {
+      uint64_t order;
+      uint64_t target_time;
+      FlutterTask task;
+    };
+
+    // Orders the heap by target time, and tasks due at the same time by the
+    // order in which they were posted.
+    struct TaskComparer
+    {
+      bool operator()(const Task &a, const Task &b) const
+      {
+        return a.target_time == b.target_time ? a.order > b.order : a.target_time > b.target_time;
+      }
+    };
+
+    FlutterTaskRunnerDescription description_ = {};
+    std::atomic<FlutterEngine> engine_{nullptr};
+
+    std::mutex mutex_;
+    std::priority_queue<Task, std::vector<Task>, TaskComparer> tasks_;
+    uint64_t task_order_ = 0;
+    // Reused on every run so that servicing tasks does not allocate.
+    std::vector<FlutterTask> expired_tasks_;
+    uint64_t current_task_start_nanos_ = 0;
+
+    bool RunsTasksOnCurrentThread() const;
+    void PostTask(FlutterTask task, uint64_t target_time_nanos);
+    void ArmTimer(uint64_t target_time_nanos);
+
+    // Disallow copy and assign operations.
+    TaskRunner(const TaskRunner &) = delete;
+    void operator=(const TaskRunner &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "tdm_vsync_source.h"
+
+#include <sys/epoll.h>
+
+#include "logger.h"
+
+TdmVsyncSource::TdmVsyncSource()
+{
+  tdm_error ret;
+  client_ = tdm_client_create(&ret);
+  if (ret != TDM_ERROR_NONE)
+  {
+    LogE("tdm_client_create has failed.");
+    return;
+  }
+
+  output_ = tdm_client_get_output(client_, const_cast<char *>("default"), &ret);
+  if (ret != TDM_ERROR_NONE)
+  {
+    LogE("tdm_client_get_output has failed.");
+    return;
+  }
+
+  unsigned int refresh_rate = 0;
+  if (tdm_client_output_get_refresh_rate(output_, &refresh_rate) == TDM_ERROR_NONE &&
+      refresh_rate > 0)
+  {
+    refresh_period_nanos_ = 1e9 / refresh_rate;
+  }
+  else
+  {
+    LogW("Could not get the output refresh rate.");
+  }
+
+  vblank_ = tdm_client_output_create_vblank(output_, &ret);
+  if (ret != TDM_ERROR_NONE)
+  {
+    LogE("tdm_client_output_create_vblank has failed.");
+    return;
+  }
+
+  if (tdm_client_get_fd(client_, &fd_) != TDM_ERROR_NONE || fd_ < 0)
+  {
+    LogE("tdm_client_get_fd has failed.");
+    return;
+  }
+
+  valid_ = true;
+}
+
+TdmVsyncSource::~TdmVsyncSource()
+{
+  if (vblank_)
+  {
+    tdm_client_vblank_destroy(vblank_);
+  }
+
+  if (client_)
+  {
+    tdm_client_destroy(client_);
+  }
+}
+
+bool TdmVsyncSource::IsValid() const { return valid_; }
+
+int TdmVsyncSource::GetFd() const { return fd_; }
+
+double TdmVsyncSource::GetRefreshPeriodNanos() const { return refresh_period_nanos_; }
+
+bool TdmVsyncSource::RequestVblank()
+{
+  // The request is flushed to the server here. The reply is dispatched by
+  // HandleEvents() once the tdm fd becomes readable.
+  tdm_error ret = tdm_client_vblank_wait(vblank_, 1, TdmClientVblankCallback, this);
+  if (ret != TDM_ERROR_NONE)
+  {
+    LogW("tdm_client_vblank_wait has returned an error.");
+    return false;
+  }
+  return true;
+}
+
+void TdmVsyncSource::HandleEvents(uint32_t events)
+{
+  if (events & (EPOLLERR | EPOLLHUP))
+  {
+    LogE("The tdm client connection has been lost.");
+    return;
+  }
+
+  if (events & EPOLLIN)
+  {
+    // The fd is readable, so this dispatches without blocking.
+    if (tdm_client_handle_events(client_) != TDM_ERROR_NONE)
+    {
+      LogW("tdm_client_handle_events has returned an error.");
+    }
+  }
+}
+
+void TdmVsyncSource::TdmClientVblankCallback(tdm_client_vblank *vblank,
+                                             tdm_error error,
+                                             unsigned int sequence,
+                                             unsigned int tv_sec,
+                                             unsigned int tv_usec,
+                                             void *user_data)
+{
+  TdmVsyncSource *source = reinterpret_cast<TdmVsyncSource *>(user_data);
+
+  uint64_t vblank_nanos = tv_sec * 1000000000ull + tv_usec * 1000ull;
+  source->delegate_->OnVblank(vblank_nanos, sequence);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <tdm_client.h>
+
+#include "vsync_source.h"
+
+// Vblank events of the default output delivered by the tdm server.
+class TdmVsyncSource : public VsyncSource
+{
+public:
+  TdmVsyncSource();
+  virtual ~TdmVsyncSource();
+  bool IsValid() const override;
+  int GetFd() const override;
+  double GetRefreshPeriodNanos() const override;
+  bool RequestVblank() override;
+  void HandleEvents(uint32_t events) override;
+
+private:
+  tdm_client *client_ = nullptr;
+  tdm_client_output *output_ = nullptr;
+  tdm_client_vblank *vblank_ = nullptr;
+  int fd_ = -1;
+  double refresh_period_nanos_ = 0;
+  bool valid_ = false;
+
+  static void TdmClientVblankCallback(tdm_client_vblank *vblank,
+                                      tdm_error error,
+                                      unsigned int sequence,
+                                      unsigned int tv_sec,
+                                      unsigned int tv_usec,
+                                      void *user_data);
+};
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "text_input_channel.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <Ecore_Input.h>
+
+#include "logger.h"
+
+namespace flutter
+{
+  // Just enough of a JSON reader for the method calls of the channel. Each
+  // function takes the start of a value and returns the position after it, or
+  // null if it is malformed.
+
+  static const char *SkipSpace(const char *p, const char *end)
+  {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+    {
+      p++;
+    }
+    return p;
+  }
+
+  // Writes the one or two UTF-16 units of |code_point| and returns how many.
+  static size_t EncodeUtf16(uint32_t code_point, char16_t *units)
+  {
+    if (code_point >= 0x10000)
+    {
+      code_point -= 0x10000;
+      units[0] = static_cast<char16_t>(0xd800 + (code_point >> 10));
+      units[1] = static_cast<char16_t>(0xdc00 + (code_point & 0x3ff));
+      return 2;
+    }
+    units[0] = static_cast<char16_t>(code_point);
+    return 1;
+  }
+
+  // Decodes the UTF-8 sequence at |p|, which is advanced past it.
+  static uint32_t NextCodePoint(const char *&p, const char *end)
+  {
+    auto byte = static_cast<unsigned char>(*p++);
+    uint32_t code_point = byte;
+    size_t length = 0;
+    if (byte >= 0xf0)
+    {
+      code_point &= 0x07;
+      length = 3;
+    }
+    else if (byte >= 0xe0)
+    {
+      code_point &= 0x0f;
+      length = 2;
+    }
+    else if (byte >= 0xc0)
+    {
+      code_point &= 0x1f;
+      length = 1;
+    }
+    for (size_t i = 0; i < length && p < end && (*p & 0xc0) == 0x80; i++)
+    {
+      code_point = (code_point << 6) | (*p++ & 0x3f);
+    }
+    return code_point;
+  }
+
+  // Decodes the string at |p| into |out| if not null.
+  static const char *ParseString(const char *p, const char *end, std::u16string *out)
+  {
+    if (p == end || *p != '"')
+    {
+      return nullptr;
+    }
+    p++;
+    while (p < end && *p != '"')
+    {
+      if (*p != '\\')
+      {
+        char16_t units[2];
+        size_t count = EncodeUtf16(NextCodePoint(p, end), units);
+        if (out)
+        {
+          out->append(units, count);
+        }
+        continue;
+      }
+      if (++p == end)
+      {
+        return nullptr;
+      }
+      char16_t unit = *p;
+      switch (*p++)
+      {
+      case 'b':
+        unit = '\b';
+        break;
+      case 'f':
+        unit = '\f';
+        break;
+      case 'n':
+        unit = '\n';
+        break;
+      case 'r':
+        unit = '\r';
+        break;
+      case 't':
+        unit = '\t';
+        break;
+      case 'u':
+      {
+        // Surrogate pairs are escaped as two units, and copied as such.
+        char digits[5] = {};
+        if (end - p < 4)
+        {
+          return nullptr;
+        }
+        memcpy(digits, p, 4);
+        unit = static_cast<char16_t>(strtoul(digits, nullptr, 16));
+        p += 4;
+        break;
+      }
+      }
+      if (out)
+      {
+        out->push_back(unit);
+      }
+    }
+    return p < end ? p + 1 : nullptr;
+  }
+
+  // Whether the string at |p| is |literal|, which has nothing to escape.
+  static bool StringEquals(const char *p, const char *end, const char *literal)
+  {
+    size_t length = strlen(literal);
+    return end - p >= static_cast<ptrdiff_t>(length + 2) && p[0] == '"' &&
+           memcmp(p + 1, literal, length) == 0 && p[length + 1] == '"';
+  }
+
+  static const char *SkipValue(const char *p, const char *end)
+  {
+    if (p == end)
+    {
+      return nullptr;
+    }
+    if (*p == '"')
+    {
+      return ParseString(p, end, nullptr);
+    }
+    if (*p == '{' || *p == '[')
+    {
+      int depth = 0;
+      while (p < end)
+      {
+        if (*p == '"')
+        {
+          p = ParseString(p, end, nullptr);
+          if (!p)
+          {
+            return nullptr;
+          }
+          continue;
+        }
+        depth += *p == '{' || *p == '[' ? 1 : *p == '}' || *p == ']' ? -1 : 0;
+        p++;
+        if (depth == 0)
+        {
+          return p;
+        }
+      }
+      return nullptr;
+    }
+    // A number or a literal.
+    while (p < end && !strchr(",}] \t\n\r", *p))
+    {
+      p++;
+    }
+    return p;
+  }
+
+  // Returns the value of the member |name| of the object at |p|.
+  static const char *FindMember(const char *p, const char *end, const char *name)
+  {
+    if (!p || p == end || *p != '{')
+    {
+      return nullptr;
+    }
+    p = SkipSpace(p + 1, end);
+    while (p < end && *p == '"')
+    {
+      const char *key = p;
+      p = ParseString(p, end, nullptr);
+      if (!p)
+      {
+        return nullptr;
+      }
+      p = SkipSpace(p, end);
+      if (p == end || *p != ':')
+      {
+        return nullptr;
+      }
+      p = SkipSpace(p + 1, end);
+      if (StringEquals(key, end, name))
+      {
+        return p;
+      }
+      p = SkipValue(p, end);
+      if (!p)
+      {
+        return nullptr;
+      }
+      p = SkipSpace(p, end);
+      if (p == end || *p != ',')
+      {
+        return nullptr;
+      }
+      p = SkipSpace(p + 1, end);
+    }
+    return nullptr;
+  }
+
+  static int64_t ParseInt(const char *p, const char *end, int64_t fallback)
+  {
+    char digits[24] = {};
+    size_t length = 0;
+    while (p && p < end && length < sizeof(digits) - 1 && (*p == '-' || (*p >= '0' && *p <= '9')))
+    {
+      digits[length++] = *p++;
+    }
+    return length ? strtoll(digits, nullptr, 10) : fallback;
+  }
+
+  static bool IsLowSurrogate(char16_t unit) { return unit >= 0xdc00 && unit <= 0xdfff; }
+
+  TextInputChannel::TextInputChannel(FlutterEngine engine) : engine_(engine) {}
+
+  void TextInputChannel::HandleMessage(const FlutterPlatformMessage &message)
+  {
+    auto *begin = reinterpret_cast<const char *>(message.message);
+    const char *end = begin + message.message_size;
+    const char *root = SkipSpace(begin, end);
+    const char *method = FindMember(root, end, "method");
+    const char *args = FindMember(root, end, "args");
+    if (!method)
+    {
+      SendResponse(message, false);
+      return;
+    }
+
+    if (StringEquals(method, end, "TextInput.setClient"))
+    {
+      // [client id, configuration]
+      const char *config = nullptr;
+      if (args && *args == '[')
+      {
+        const char *id = SkipSpace(args + 1, end);
+        client_id_ = ParseInt(id, end, -1);
+        const char *p = SkipValue(id, end);
+        p = p ? SkipSpace(p, end) : nullptr;
+        config = p && p < end && *p == ',' ? SkipSpace(p + 1, end) : nullptr;
+      }
+      const char *action = FindMember(config, end, "inputAction");
+      const char *action_end = action ? ParseString(action, end, nullptr) : nullptr;
+      if (action_end)
+      {
+        input_action_.assign(action + 1, action_end - 1);
+      }
+      else
+      {
+        input_action_ = "TextInputAction.done";
+      }
+      const char *type_name = FindMember(FindMember(config, end, "inputType"), end, "name");
+      multiline_ = type_name && StringEquals(type_name, end, "TextInputType.multiline");
+    }
+    else if (StringEquals(method, end, "TextInput.clearClient"))
+    {
+      client_id_ = -1;
+    }
+    else if (StringEquals(method, end, "TextInput.setEditingState"))
+    {
+      text_.clear();
+      ParseString(FindMember(args, end, "text"), end, &text_);
+      int64_t base = ParseInt(FindMember(args, end, "selectionBase"), end, -1);
+      int64_t extent = ParseInt(FindMember(args, end, "selectionExtent"), end, -1);
+      // An invalid selection puts the cursor at the end.
+      selection_base_ = base < 0 ? text_.size() : std::min<size_t>(base, text_.size());
+      selection_extent_ = extent < 0 ? selection_base_ : std::min<size_t>(extent, text_.size());
+    }
+    else if (!StringEquals(method, end, "TextInput.show") && !StringEquals(method, end, "TextInput.hide") &&
+             !StringEquals(method, end, "TextInput.setEditableSizeAndTransform") &&
+             !StringEquals(method, end, "TextInput.setMarkedTextRect") &&
+             !StringEquals(method, end, "TextInput.setStyle") &&
+             !StringEquals(method, end, "TextInput.requestAutofill") &&
+             !StringEquals(method, end, "TextInput.finishAutofillContext"))
+    {
+      SendResponse(message, false);
+      return;
+    }
+    SendResponse(message, true);
+  }
+
+  bool TextInputChannel::OnKeyDown(const char *key, const char *string, unsigned int modifiers)
+  {
+    if (client_id_ < 0 || !key || (modifiers & (ECORE_EVENT_MODIFIER_CTRL | ECORE_EVENT_MODIFIER_ALT)))
+    {
+      return false;
+    }
+
+    size_t start = std::min(selection_base_, selection_extent_);
+    size_t end = std::max(selection_base_, selection_extent_);
+    if (strcmp(key, "BackSpace") == 0)
+    {
+      if (start == end && start > 0)
+      {
+        start -= start > 1 && IsLowSurrogate(text_[start - 1]) ? 2 : 1;
+      }
+      Erase(start, end);
+    }
+    else if (strcmp(key, "Delete") == 0)
+    {
+      if (start == end && end < text_.size())
+      {
+        end += end + 1 < text_.size() && IsLowSurrogate(text_[end + 1]) ? 2 : 1;
+      }
+      Erase(start, end);
+    }
+    else if (strcmp(key, "Left") == 0)
+    {
+      if (start == end && start > 0)
+      {
+        start -= start > 1 && IsLowSurrogate(text_[start - 1]) ? 2 : 1;
+      }
+      selection_base_ = selection_extent_ = start;
+    }
+    else if (strcmp(key, "Right") == 0)
+    {
+      if (start == end && end < text_.size())
+      {
+        end += end + 1 < text_.size() && IsLowSurrogate(text_[end + 1]) ? 2 : 1;
+      }
+      selection_base_ = selection_extent_ = end;
+    }
+    else if (strcmp(key, "Home") == 0)
+    {
+      selection_base_ = selection_extent_ = 0;
+    }
+    else if (strcmp(key, "End") == 0)
+    {
+      selection_base_ = selection_extent_ = text_.size();
+    }
+    else if (strcmp(key, "Return") == 0 || strcmp(key, "KP_Enter") == 0)
+    {
+      if (!multiline_)
+      {
+        char id[24];
+        snprintf(id, sizeof(id), "%" PRId64, client_id_);
+        message_.clear();
+        message_ += "{\"method\":\"TextInputClient.performAction\",\"args\":[";
+        message_ += id;
+        message_ += ",\"";
+        message_ += input_action_;
+        message_ += "\"]}";
+        SendMessage();
+        return true;
+      }
+      Insert("\n");
+    }
+    else if (string && static_cast<unsigned char>(string[0]) >= 0x20 && string[0] != 0x7f)
+    {
+      Insert(string);
+    }
+    else
+    {
+      return false;
+    }
+
+    SendEditingState();
+    return true;
+  }
+
+  void TextInputChannel::Insert(const char *string)
+  {
+    Erase(std::min(selection_base_, selection_extent_), std::max(selection_base_, selection_extent_));
+    const char *p = string;
+    const char *end = string + strlen(string);
+    while (p < end)
+    {
+      // Decoded in chunks, so that only the growing text allocates.
+      char16_t units[16];
+      size_t count = 0;
+      while (p < end && count + 2 <= 16)
+      {
+        count += EncodeUtf16(NextCodePoint(p, end), units + count);
+      }
+      text_.insert(selection_base_, units, count);
+      selection_base_ += count;
+    }
+    selection_extent_ = selection_base_;
+  }
+
+  void TextInputChannel::Erase(size_t start, size_t end)
+  {
+    text_.erase(start, end - start);
+    selection_base_ = selection_extent_ = start;
+  }
+
+  void TextInputChannel::SendEditingState()
+  {
+    char number[32];
+    message_.clear();
+    message_ += "{\"method\":\"TextInputClient.updateEditingState\",\"args\":[";
+    snprintf(number, sizeof(number), "%" PRId64, client_id_);
+    message_ += number;
+    message_ += ",{\"text\":\"";
+    for (char16_t unit : text_)
+    {
+      if (unit == '"' || unit == '\\')
+      {
+        message_ += '\\';
+        message_ += static_cast<char>(unit);
+      }
+      else if (unit < 0x20 || unit > 0x7e)
+      {
+        snprintf(number, sizeof(number), "\\u%04x", unit);
+        message_ += number;
+      }
+      else
+      {
+        message_ += static_cast<char>(unit);
+      }
+    }
+    snprintf(number, sizeof(number), "%zu", selection_base_);
+    message_ += "\",\"selectionBase\":";
+    message_ += number;
+    snprintf(number, sizeof(number), "%zu", selection_extent_);
+    message_ += ",\"selectionExtent\":";
+    message_ += number;
+    message_ += ",\"selectionAffinity\":\"TextAffinity.downstream\",\"selectionIsDirectional\":false,"
+                "\"composingBase\":-1,\"composingExtent\":-1}]}";
+    SendMessage();
+  }
+
+  void TextInputChannel::SendMessage()
+  {
+    FlutterPlatformMessage message = {};
+    message.struct_size = sizeof(message);
+    message.channel = "flutter/textinput";
+    message.message = reinterpret_cast<const uint8_t *>(message_.data());
+    message.message_size = message_.size();
+    if (FlutterEngineSendPlatformMessage(engine_, &message) != kSuccess)
+    {
+      LogE("Could not send a text input message.");
+    }
+  }
+
+  void TextInputChannel::SendResponse(const FlutterPlatformMessage &message, bool handled)
+  {
+    // A successful call without a result, in the JSON method codec. An empty
+    // response means the method is not implemented.
+    static constexpr char kSuccessEnvelope[] = "[null]";
+    FlutterEngineSendPlatformMessageResponse(engine_, message.response_handle,
+                                             handled ? reinterpret_cast<const uint8_t *>(kSuccessEnvelope) : nullptr,
+                                             handled ? sizeof(kSuccessEnvelope) - 1 : 0);
+  }
+
+} // namespace flutter
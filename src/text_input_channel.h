@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <flutter_embedder.h>
+#include <string>
+
+namespace flutter
+{
+  // A minimal flutter/textinput implementation that edits the text of the
+  // focused field with hardware keys, without an input method. The editing
+  // state is kept in UTF-16, which is what the framework's offsets count. Must
+  // be used on the platform thread.
+  class TextInputChannel
+  {
+  public:
+    explicit TextInputChannel(FlutterEngine engine);
+
+    // Handles, and responds to, a message on the flutter/textinput channel.
+    void HandleMessage(const FlutterPlatformMessage &message);
+
+    // Applies a key press to the text of the current client. Returns false if
+    // there is no client or the key does not edit text.
+    bool OnKeyDown(const char *key, const char *string, unsigned int modifiers);
+
+  private:
+    FlutterEngine engine_;
+    // The framework's id of the focused field, or -1 if there is none.
+    int64_t client_id_ = -1;
+    bool multiline_ = false;
+    // The JSON string, without quotes, of the action of the enter key.
+    std::string input_action_;
+    std::u16string text_;
+    size_t selection_base_ = 0;
+    size_t selection_extent_ = 0;
+    // Outgoing messages, reused to keep their capacity.
+    std::string message_;
+
+    void Insert(const char *string);
+    void Erase(size_t start, size_t end);
+    void SendEditingState();
+    void SendMessage();
+    void SendResponse(const FlutterPlatformMessage &message, bool handled);
+
+    // Disallow copy and assign operations.
+    TextInputChannel(const TextInputChannel &) = delete;
+    void operator=(const TextInputChannel &) = delete;
+  };
+
+} // namespace flutter
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "timer_vsync_source.h"
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <flutter_embedder.h>
+
+#include "logger.h"
+
+TimerVsyncSource::TimerVsyncSource(double rate)
+{
+  if (rate <= 0)
+  {
+    rate = kDefaultRate;
+  }
+  period_nanos_ = 1e9 / rate;
+
+  fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (fd_ < 0)
+  {
+    LogE("Could not create the vsync timerfd.");
+    return;
+  }
+
+  epoch_nanos_ = FlutterEngineGetCurrentTime();
+}
+
+TimerVsyncSource::~TimerVsyncSource()
+{
+  if (fd_ >= 0)
+  {
+    close(fd_);
+  }
+}
+
+bool TimerVsyncSource::IsValid() const { return fd_ >= 0; }
+
+int TimerVsyncSource::GetFd() const { return fd_; }
+
+double TimerVsyncSource::GetRefreshPeriodNanos() const { return period_nanos_; }
+
+bool TimerVsyncSource::RequestVblank()
+{
+  if (armed_)
+  {
+    return true;
+  }
+
+  uint64_t now = FlutterEngineGetCurrentTime();
+  next_tick_ = static_cast<uint64_t>((now - epoch_nanos_) / period_nanos_) + 1;
+  uint64_t deadline = epoch_nanos_ + static_cast<uint64_t>(next_tick_ * period_nanos_);
+
+  itimerspec spec = {};
+  spec.it_value.tv_sec = deadline / 1000000000ull;
+  spec.it_value.tv_nsec = deadline % 1000000000ull;
+  if (timerfd_settime(fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0)
+  {
+    LogE("Could not arm the vsync timerfd.");
+    return false;
+  }
+
+  armed_ = true;
+  return true;
+}
+
+void TimerVsyncSource::HandleEvents(uint32_t events)
+{
+  if (!(events & EPOLLIN))
+  {
+    return;
+  }
+
+  uint64_t expirations;
+  if (read(fd_, &expirations, sizeof(expirations)) != sizeof(expirations))
+  {
+    return;
+  }
+
+  armed_ = false;
+  uint64_t tick_nanos = epoch_nanos_ + static_cast<uint64_t>(next_tick_ * period_nanos_);
+  delegate_->OnVblank(tick_nanos, static_cast<unsigned int>(next_tick_));
+}
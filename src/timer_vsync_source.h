@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include "vsync_source.h"
+
+// A software vsync clock ticking at a fixed rate, for devices and hosts
+// without access to display timing.
+class TimerVsyncSource : public VsyncSource
+{
+public:
+  explicit TimerVsyncSource(double rate);
+  virtual ~TimerVsyncSource();
+  bool IsValid() const override;
+  int GetFd() const override;
+  double GetRefreshPeriodNanos() const override;
+  bool RequestVblank() override;
+  void HandleEvents(uint32_t events) override;
+
+private:
+  static constexpr double kDefaultRate = 60.0;
+
+  int fd_ = -1;
+  double period_nanos_ = 0;
+  // Ticks are kept in phase with this point so that the clock does not drift
+  // with the time at which frames happen to be requested.
+  uint64_t epoch_nanos_ = 0;
+  uint64_t next_tick_ = 0;
+  bool armed_ = false;
+};
@@ -3,11 +3,76 @@
 // found in the LICENSE file.
 
 #include "tizen_display.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "logger.h"
 
+#ifndef EGL_NATIVE_SURFACE_TIZEN
+#define EGL_NATIVE_SURFACE_TIZEN 0x32A1
+#endif
+
 namespace flutter
 {
-  TizenDisplay::TizenDisplay(uint32_t display_width, uint32_t display_height)
+  // Bound to a const reference by std::min, so it needs a definition in C++14.
+  constexpr size_t TizenDisplay::kMaxDamageHistory;
+
+  // The binding last made by eglMakeCurrent on this thread. The engine binds
+  // and unbinds around every frame, often to what is already current.
+  struct EGLBinding
+  {
+    // False after a failed call, when the actual binding is unknown.
+    bool known = true;
+    uint64_t generation = 0;
+    EGLSurface draw = EGL_NO_SURFACE;
+    EGLSurface read = EGL_NO_SURFACE;
+    EGLContext context = EGL_NO_CONTEXT;
+  };
+
+  static thread_local EGLBinding current_binding;
+
+  static std::atomic<uint64_t> display_generation{0};
+
+  static bool HasExtension(const char *extensions, const char *name)
+  {
+    if (!extensions)
+    {
+      return false;
+    }
+
+    size_t length = strlen(name);
+    for (const char *found = strstr(extensions, name); found; found = strstr(found + length, name))
+    {
+      bool starts = found == extensions || found[-1] == ' ';
+      bool ends = found[length] == ' ' || found[length] == '\0';
+      if (starts && ends)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static FlutterRect UnionRect(const FlutterRect &a, const FlutterRect &b)
+  {
+    return {std::min(a.left, b.left), std::min(a.top, b.top),
+            std::max(a.right, b.right), std::max(a.bottom, b.bottom)};
+  }
+
+  static bool ContainsRect(const FlutterRect &outer, const FlutterRect &inner)
+  {
+    return inner.left >= outer.left && inner.top >= outer.top &&
+           inner.right <= outer.right && inner.bottom <= outer.bottom;
+  }
+
+  TizenDisplay::TizenDisplay(uint32_t display_width, uint32_t display_height,
+                             FlutterDesktopRenderer renderer, FlutterDesktopPixelFormat software_pixel_format,
+                             const SurfaceConfig &surface_config)
+      : renderer_(renderer), generation_(++display_generation)
   {
     display_width_ = display_width;
     display_height_ = display_height;
@@ -40,7 +105,28 @@ namespace flutter
       ecore_wl2_window_alpha_set(wl2_window_, EINA_FALSE);
       ecore_wl2_window_show(wl2_window_);
       ecore_wl2_window_geometry_set(wl2_window_, 0, 0, display_width_, display_height_);
+    }
+
+    if (renderer_ == kFlutterDesktopRendererSoftware)
+    {
+      uint32_t format = software_pixel_format == kFlutterDesktopPixelFormatRGB565 ? WL_SHM_FORMAT_RGB565
+                                                                                 : WL_SHM_FORMAT_XRGB8888;
+      swapchain_ = std::make_unique<ShmSwapchain>(ecore_wl2_display_get(wl2_display_),
+                                                  ecore_wl2_display_shm_get(wl2_display_),
+                                                  ecore_wl2_window_surface_get(wl2_window_),
+                                                  display_width_, display_height_, format);
+      if (!swapchain_->IsValid())
+      {
+        LogE("Could not create the wl_shm swapchain.");
+        return;
+      }
 
+      valid_ = true;
+      return;
+    }
+
+    // Create the EGL window.
+    {
       egl_window_ = ecore_wl2_egl_window_create(wl2_window_, display_width_, display_height_);
       if (!egl_window_)
       {
@@ -65,25 +151,40 @@ namespace flutter
       }
     }
 
-    // Choose an EGL config.
-    EGLConfig config = {0};
+    // Look up the extensions used for partial presentation.
     {
-      EGLint num_config = 0;
-      const EGLint attribute_list[] = {
-          EGL_RED_SIZE, 8,
-          EGL_GREEN_SIZE, 8,
-          EGL_BLUE_SIZE, 8,
-          EGL_ALPHA_SIZE, 8,
-          EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-          EGL_NONE};
+      const char *extensions = ::eglQueryString(display_, EGL_EXTENSIONS);
 
-      if (::eglChooseConfig(display_, attribute_list, &config, 1, &num_config) != EGL_TRUE)
+      buffer_age_supported_ = HasExtension(extensions, "EGL_EXT_buffer_age");
+
+      if (HasExtension(extensions, "EGL_KHR_swap_buffers_with_damage"))
       {
-        LogE("Could not choose an EGL config.");
-        return;
+        swap_buffers_with_damage_ = reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            ::eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
       }
+      else if (HasExtension(extensions, "EGL_EXT_swap_buffers_with_damage"))
+      {
+        // Same signature as the KHR variant.
+        swap_buffers_with_damage_ = reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            ::eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+      }
+    }
+
+    // Look up the functions used to import external textures.
+    {
+      create_image_ = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(::eglGetProcAddress("eglCreateImageKHR"));
+      destroy_image_ = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(::eglGetProcAddress("eglDestroyImageKHR"));
     }
 
+    // Choose an EGL config.
+    EGLConfig config = {0};
+    if (!ChooseConfig(surface_config, &config))
+    {
+      LogE("Could not choose an EGL config.");
+      return;
+    }
+    surface_has_alpha_ = surface_config.format == kFlutterDesktopSurfaceFormatRGBA8888;
+
     // Create the EGL context.
     {
       const EGLint context_attributes[] = {
@@ -118,11 +219,22 @@ namespace flutter
       }
     }
 
+    // GL resources are only created once the render thread starts drawing.
+    compositor_ = std::make_unique<GLCompositor>(display_width_, display_height_);
+    platform_views_ = std::make_unique<PlatformViewManager>(wl2_window_);
+
     valid_ = true;
   }
 
   TizenDisplay::~TizenDisplay()
   {
+    // The compositor owns GL objects, so its context has to be current here.
+    if (compositor_ && MakeCurrent(surface_, surface_, context_))
+    {
+      compositor_.reset();
+      MakeCurrent(EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
     if (surface_ != EGL_NO_SURFACE)
     {
       ::eglDestroySurface(display_, surface_);
@@ -147,6 +259,9 @@ namespace flutter
       display_ = EGL_NO_DISPLAY;
     }
 
+    platform_views_.reset();
+    swapchain_.reset();
+
     if (egl_window_)
     {
       ecore_wl2_egl_window_destroy(egl_window_);
@@ -168,12 +283,217 @@ namespace flutter
     ecore_wl2_shutdown();
   }
 
+  bool TizenDisplay::ChooseConfig(const SurfaceConfig &surface_config, EGLConfig *config_out) const
+  {
+    EGLint red_size = 8, green_size = 8, blue_size = 8, alpha_size = 8;
+    if (surface_config.format == kFlutterDesktopSurfaceFormatRGB888)
+    {
+      alpha_size = 0;
+    }
+    else if (surface_config.format == kFlutterDesktopSurfaceFormatRGB565)
+    {
+      red_size = 5;
+      green_size = 6;
+      blue_size = 5;
+      alpha_size = 0;
+    }
+
+    const EGLint attribute_list[] = {
+        EGL_RED_SIZE, red_size,
+        EGL_GREEN_SIZE, green_size,
+        EGL_BLUE_SIZE, blue_size,
+        EGL_ALPHA_SIZE, alpha_size,
+        EGL_DEPTH_SIZE, surface_config.depth_bits,
+        EGL_STENCIL_SIZE, surface_config.stencil_bits,
+        EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+        EGL_NONE};
+
+    EGLint num_config = 0;
+    if (::eglChooseConfig(display_, attribute_list, nullptr, 0, &num_config) != EGL_TRUE || num_config == 0)
+    {
+      return false;
+    }
+    std::vector<EGLConfig> configs(num_config);
+    ::eglChooseConfig(display_, attribute_list, configs.data(), num_config, &num_config);
+    configs.resize(num_config);
+    if (configs.empty())
+    {
+      return false;
+    }
+
+    // eglChooseConfig sorts deeper colors first, so RGBA8888 would come before
+    // RGB565. Prefer the config closest to the request instead, and spend
+    // memory on extra depth, stencil or samples last.
+    EGLConfig best_config = configs[0];
+    int64_t best_score = INT64_MAX;
+    for (EGLConfig config : configs)
+    {
+      EGLint red = 0, green = 0, blue = 0, alpha = 0, depth = 0, stencil = 0, config_samples = 0;
+      ::eglGetConfigAttrib(display_, config, EGL_RED_SIZE, &red);
+      ::eglGetConfigAttrib(display_, config, EGL_GREEN_SIZE, &green);
+      ::eglGetConfigAttrib(display_, config, EGL_BLUE_SIZE, &blue);
+      ::eglGetConfigAttrib(display_, config, EGL_ALPHA_SIZE, &alpha);
+      ::eglGetConfigAttrib(display_, config, EGL_DEPTH_SIZE, &depth);
+      ::eglGetConfigAttrib(display_, config, EGL_STENCIL_SIZE, &stencil);
+      ::eglGetConfigAttrib(display_, config, EGL_SAMPLES, &config_samples);
+
+      int64_t score = (red - red_size) + (green - green_size) + (blue - blue_size);
+      score = score * 64 + (alpha - alpha_size);
+      score = score * 64 + config_samples;
+      score = score * 64 + (depth - surface_config.depth_bits) + (stencil - surface_config.stencil_bits);
+      if (score < best_score)
+      {
+        best_score = score;
+        best_config = config;
+      }
+    }
+
+    EGLint id = 0;
+    ::eglGetConfigAttrib(display_, best_config, EGL_CONFIG_ID, &id);
+    LogI("Using EGL config %d of %zu candidates.", id, configs.size());
+    *config_out = best_config;
+    return true;
+  }
+
   bool TizenDisplay::IsValid() const { return valid_; }
 
   size_t TizenDisplay::GetWidth() const { return display_width_; }
 
   size_t TizenDisplay::GetHeight() const { return display_height_; }
 
+  wl_display *TizenDisplay::GetWaylandDisplay() const
+  {
+    return ecore_wl2_display_get(wl2_display_);
+  }
+
+  wl_surface *TizenDisplay::GetWaylandSurface() const
+  {
+    return ecore_wl2_window_surface_get(wl2_window_);
+  }
+
+  unsigned int TizenDisplay::GetWindowId() const
+  {
+    return ecore_wl2_window_id_get(wl2_window_);
+  }
+
+  bool TizenDisplay::SetRotation(int32_t degrees, bool server_request)
+  {
+    if (!egl_window_)
+    {
+      LogE("Rotation is only supported by the OpenGL renderer.");
+      return false;
+    }
+
+    // The buffer itself is rotated on the render thread, by
+    // OnApplicationSetBufferRotation().
+    ecore_wl2_window_rotation_set(wl2_window_, degrees);
+    if (server_request)
+    {
+      ecore_wl2_window_rotation_change_done_send(wl2_window_, degrees, display_width_, display_height_);
+    }
+    return true;
+  }
+
+  void TizenDisplay::RejectRotationRequest()
+  {
+    int degrees = ecore_wl2_window_rotation_get(wl2_window_);
+    ecore_wl2_window_rotation_change_done_send(wl2_window_, degrees, display_width_, display_height_);
+  }
+
+  bool TizenDisplay::SetAvailableRotations(const int32_t *degrees, size_t count)
+  {
+    if (!egl_window_)
+    {
+      LogE("Rotation is only supported by the OpenGL renderer.");
+      return false;
+    }
+    std::vector<int> rotations(degrees, degrees + count);
+    ecore_wl2_window_available_rotations_set(wl2_window_, rotations.data(), rotations.size());
+    return true;
+  }
+
+  void TizenDisplay::GetRenderStats(FlutterDesktopRenderStats *stats) const
+  {
+    stats->make_current_count = make_current_count_;
+    stats->make_current_skipped_count = make_current_skipped_count_;
+    stats->full_present_count = full_present_count_;
+    stats->partial_present_count = partial_present_count_;
+    if (compositor_)
+    {
+      compositor_->GetRenderStats(stats);
+    }
+    proc_resolver_.GetRenderStats(stats);
+  }
+
+  wl_surface *TizenDisplay::CreatePlatformViewSurface(FlutterPlatformViewIdentifier view_id)
+  {
+    if (!surface_has_alpha_)
+    {
+      LogE("Platform views cannot be shown with an opaque surface format.");
+      return nullptr;
+    }
+    return platform_views_ ? platform_views_->CreateView(view_id) : nullptr;
+  }
+
+  bool TizenDisplay::DestroyPlatformViewSurface(FlutterPlatformViewIdentifier view_id)
+  {
+    return platform_views_ ? platform_views_->DestroyView(view_id) : false;
+  }
+
+  bool TizenDisplay::MakeCurrent(EGLSurface draw, EGLSurface read, EGLContext context)
+  {
+    EGLBinding &binding = current_binding;
+    bool unbound = binding.context == EGL_NO_CONTEXT && context == EGL_NO_CONTEXT;
+    bool unchanged = binding.generation == generation_ && binding.draw == draw &&
+                     binding.read == read && binding.context == context;
+    if (binding.known && (unbound || unchanged))
+    {
+      make_current_skipped_count_++;
+      return true;
+    }
+
+    make_current_count_++;
+    if (::eglMakeCurrent(display_, draw, read, context) != EGL_TRUE)
+    {
+      binding.known = false;
+      return false;
+    }
+
+    binding.known = true;
+    binding.generation = generation_;
+    binding.draw = draw;
+    binding.read = read;
+    binding.context = context;
+    return true;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  FlutterRendererType TizenDisplay::GetRendererType() const
+  {
+    return renderer_ == kFlutterDesktopRendererSoftware ? kSoftware : kOpenGL;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool TizenDisplay::OnApplicationPresentSoftware(const void *allocation, size_t row_bytes, size_t height)
+  {
+    if (!valid_ || !swapchain_)
+    {
+      LogE("Cannot present an invalid display.");
+      return false;
+    }
+
+    // When the display server still holds every buffer, the frame is held
+    // back rather than stalling the render thread.
+    return swapchain_->Present(allocation, row_bytes, height);
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool TizenDisplay::OnApplicationPresentHeldFrame()
+  {
+    return !valid_ || !swapchain_ || swapchain_->PresentHeldFrame();
+  }
+
   // |FlutterApplication::RenderDelegate|
   bool TizenDisplay::OnApplicationContextMakeCurrent()
   {
@@ -183,7 +503,7 @@ namespace flutter
       return false;
     }
 
-    if (::eglMakeCurrent(display_, surface_, surface_, context_) != EGL_TRUE)
+    if (!MakeCurrent(surface_, surface_, context_))
     {
       LogE("Could not make the context current.");
       return false;
@@ -201,7 +521,7 @@ namespace flutter
       return false;
     }
 
-    if (::eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, resource_context_) != EGL_TRUE)
+    if (!MakeCurrent(EGL_NO_SURFACE, EGL_NO_SURFACE, resource_context_))
     {
       LogE("Could not make the resource context current.");
       return false;
@@ -219,7 +539,7 @@ namespace flutter
       return false;
     }
 
-    if (::eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) != EGL_TRUE)
+    if (!MakeCurrent(EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT))
     {
       LogE("Could not clear the current context.");
       return false;
@@ -237,7 +557,33 @@ namespace flutter
       return false;
     }
 
-    if (::eglSwapBuffers(display_, surface_) != EGL_TRUE)
+    FlutterRect surface_rect = GetSurfaceRect();
+    FlutterRect damage = frame_damage_set_ ? frame_damage_ : surface_rect;
+    frame_damage_set_ = false;
+
+    std::copy_backward(damage_history_, damage_history_ + kMaxDamageHistory - 1, damage_history_ + kMaxDamageHistory);
+    damage_history_[0] = damage;
+    damage_history_size_ = std::min(damage_history_size_ + 1, kMaxDamageHistory);
+
+    EGLBoolean result;
+    if (swap_buffers_with_damage_ && !ContainsRect(damage, surface_rect))
+    {
+      // EGL damage rects have a bottom-left origin.
+      EGLint left = static_cast<EGLint>(std::floor(damage.left));
+      EGLint top = static_cast<EGLint>(std::floor(damage.top));
+      EGLint right = static_cast<EGLint>(std::ceil(damage.right));
+      EGLint bottom = static_cast<EGLint>(std::ceil(damage.bottom));
+      EGLint rect[4] = {left, display_height_ - bottom, right - left, bottom - top};
+      result = swap_buffers_with_damage_(display_, surface_, rect, 1);
+      partial_present_count_++;
+    }
+    else
+    {
+      result = ::eglSwapBuffers(display_, surface_);
+      full_present_count_++;
+    }
+
+    if (result != EGL_TRUE)
     {
       LogE("Could not swap buffers to present the screen.");
       return false;
@@ -247,26 +593,199 @@ namespace flutter
   }
 
   // |FlutterApplication::RenderDelegate|
-  uint32_t TizenDisplay::OnApplicationGetOnscreenFBO()
+  FlutterRect TizenDisplay::OnApplicationSetFrameDamage(const FlutterRect &damage)
   {
-    // Just FBO0.
-    return 0;
+    FlutterRect surface_rect = GetSurfaceRect();
+    frame_damage_ = {std::max(damage.left, surface_rect.left), std::max(damage.top, surface_rect.top),
+                     std::min(damage.right, surface_rect.right), std::min(damage.bottom, surface_rect.bottom)};
+    frame_damage_.right = std::max(frame_damage_.right, frame_damage_.left);
+    frame_damage_.bottom = std::max(frame_damage_.bottom, frame_damage_.top);
+    frame_damage_set_ = true;
+
+    // An age of N means the back buffer holds the frame presented N frames
+    // ago, so it misses the damage of the N - 1 frames presented since.
+    int age = GetBufferAge();
+    if (age <= 0 || static_cast<size_t>(age - 1) > damage_history_size_)
+    {
+      return surface_rect;
+    }
+
+    FlutterRect repaint = frame_damage_;
+    for (int i = 0; i < age - 1; i++)
+    {
+      repaint = UnionRect(repaint, damage_history_[i]);
+    }
+    return repaint;
   }
 
   // |FlutterApplication::RenderDelegate|
-  void *TizenDisplay::GetProcAddress(const char *name)
+  bool TizenDisplay::OnApplicationCreateBackingStore(const FlutterBackingStoreConfig &config,
+                                                     FlutterBackingStore *backing_store_out)
   {
-    if (name == nullptr)
+    if (!OnApplicationContextMakeCurrent())
+    {
+      return false;
+    }
+
+    if (!compositor_->CreateBackingStore(config, backing_store_out))
+    {
+      LogE("Could not create a backing store.");
+      return false;
+    }
+    return true;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool TizenDisplay::OnApplicationCollectBackingStore(const FlutterBackingStore &backing_store)
+  {
+    if (!compositor_ || !OnApplicationContextMakeCurrent())
+    {
+      return false;
+    }
+
+    return compositor_->CollectBackingStore(backing_store);
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  bool TizenDisplay::OnApplicationPresentLayers(const FlutterLayer **layers, size_t layers_count)
+  {
+    if (!compositor_ || !OnApplicationContextMakeCurrent())
+    {
+      return false;
+    }
+
+    FlutterRect damage = compositor_->ComputeDamage(layers, layers_count);
+    FlutterRect repaint_rect = OnApplicationSetFrameDamage(damage);
+    if (!compositor_->DrawLayers(layers, layers_count, repaint_rect))
+    {
+      LogE("Could not composite the layers.");
+      return false;
+    }
+
+    // Committed along with the window by the swap below.
+    platform_views_->PlaceViews(layers, layers_count, compositor_->GetContentScale());
+
+    bool result = OnApplicationPresent();
+    compositor_->EndFrame();
+    return result;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void TizenDisplay::OnApplicationFrameDropped()
+  {
+    if (compositor_)
+    {
+      compositor_->Invalidate();
+    }
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void TizenDisplay::OnApplicationSetBufferRotation(int32_t degrees)
+  {
+    if (!egl_window_)
+    {
+      return;
+    }
+    // The buffer keeps the unrotated size, and the engine renders into it
+    // through the surface transformation. What the back buffers hold is in the
+    // old orientation.
+    ecore_wl2_egl_window_resize_with_rotation(egl_window_, 0, 0, display_width_, display_height_, degrees);
+    if (compositor_)
+    {
+      compositor_->Invalidate();
+    }
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void *TizenDisplay::OnApplicationCreateExternalImage(const FlutterDesktopExternalBuffer &buffer)
+  {
+    if (!create_image_)
     {
       return nullptr;
     }
 
-    if (auto address = eglGetProcAddress(name))
+    EGLImageKHR image = EGL_NO_IMAGE_KHR;
+    if (buffer.type == kFlutterDesktopExternalBufferTbmSurface)
     {
-      return reinterpret_cast<void *>(address);
+      const EGLint attributes[] = {EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE};
+      image = create_image_(display_, EGL_NO_CONTEXT, EGL_NATIVE_SURFACE_TIZEN,
+                            reinterpret_cast<EGLClientBuffer>(buffer.tbm_surface), attributes);
     }
+    else if (buffer.type == kFlutterDesktopExternalBufferDmaBuf)
+    {
+      static const EGLint kPlaneAttributes[3][3] = {
+          {EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT, EGL_DMA_BUF_PLANE0_PITCH_EXT},
+          {EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT, EGL_DMA_BUF_PLANE1_PITCH_EXT},
+          {EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT, EGL_DMA_BUF_PLANE2_PITCH_EXT},
+      };
+
+      EGLint attributes[7 + 3 * 6] = {
+          EGL_WIDTH, buffer.width,
+          EGL_HEIGHT, buffer.height,
+          EGL_LINUX_DRM_FOURCC_EXT, static_cast<EGLint>(buffer.drm_format)};
+      size_t count = 6;
+      for (uint32_t i = 0; i < buffer.plane_count && i < 3; i++)
+      {
+        attributes[count++] = kPlaneAttributes[i][0];
+        attributes[count++] = buffer.plane_fds[i];
+        attributes[count++] = kPlaneAttributes[i][1];
+        attributes[count++] = static_cast<EGLint>(buffer.plane_offsets[i]);
+        attributes[count++] = kPlaneAttributes[i][2];
+        attributes[count++] = static_cast<EGLint>(buffer.plane_strides[i]);
+      }
+      attributes[count] = EGL_NONE;
 
-    return nullptr;
+      image = create_image_(display_, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attributes);
+    }
+
+    if (image == EGL_NO_IMAGE_KHR)
+    {
+      LogE("Could not create an EGL image (0x%x).", ::eglGetError());
+      return nullptr;
+    }
+    return image;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void TizenDisplay::OnApplicationDestroyExternalImage(void *image)
+  {
+    if (destroy_image_ && image)
+    {
+      destroy_image_(display_, image);
+    }
+  }
+
+  FlutterRect TizenDisplay::GetSurfaceRect() const
+  {
+    return {0, 0, static_cast<double>(display_width_), static_cast<double>(display_height_)};
+  }
+
+  int TizenDisplay::GetBufferAge()
+  {
+    if (!buffer_age_supported_)
+    {
+      return 0;
+    }
+
+    EGLint age = 0;
+    if (::eglQuerySurface(display_, surface_, EGL_BUFFER_AGE_EXT, &age) != EGL_TRUE)
+    {
+      return 0;
+    }
+    return age;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  uint32_t TizenDisplay::OnApplicationGetOnscreenFBO()
+  {
+    // Just FBO0.
+    return 0;
+  }
+
+  // |FlutterApplication::RenderDelegate|
+  void *TizenDisplay::GetProcAddress(const char *name)
+  {
+    return proc_resolver_.Resolve(name);
   }
 
 } // namespace flutter
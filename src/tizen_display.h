@@ -5,21 +5,57 @@
 #pragma once
 
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <atomic>
+#include <memory>
 #define EFL_BETA_API_SUPPORT
 #include <Ecore_Wl2.h>
 
 #include "flutter_application.h"
+#include "gl_compositor.h"
+#include "gl_proc_resolver.h"
+#include "platform_view_manager.h"
+#include "shm_swapchain.h"
+#include "flutter_tizen.h"
 
 namespace flutter
 {
+  // The requested properties of the EGL window surface.
+  struct SurfaceConfig
+  {
+    FlutterDesktopSurfaceFormat format = kFlutterDesktopSurfaceFormatRGBA8888;
+    int32_t depth_bits = 0;
+    int32_t stencil_bits = 0;
+  };
+
   class TizenDisplay : public FlutterApplication::RenderDelegate
   {
   public:
-    TizenDisplay(uint32_t display_width, uint32_t display_height);
+    TizenDisplay(uint32_t display_width, uint32_t display_height,
+                 FlutterDesktopRenderer renderer = kFlutterDesktopRendererOpenGL,
+                 FlutterDesktopPixelFormat software_pixel_format = kFlutterDesktopPixelFormatXRGB8888,
+                 const SurfaceConfig &surface_config = SurfaceConfig());
     virtual ~TizenDisplay();
     bool IsValid() const;
     size_t GetWidth() const;
     size_t GetHeight() const;
+    wl_display *GetWaylandDisplay() const;
+    wl_surface *GetWaylandSurface() const;
+    void GetRenderStats(FlutterDesktopRenderStats *stats) const;
+    unsigned int GetWindowId() const;
+    // Tells the display server that the window is rotated clockwise by
+    // |degrees|, so that it rotates the buffers at scanout. The window keeps
+    // its size. |server_request| acknowledges a rotation asked for by the
+    // window manager. Only supported by the OpenGL renderer.
+    bool SetRotation(int32_t degrees, bool server_request = false);
+    // Answers a rotation asked for by the window manager that cannot be
+    // applied, which keeps the current one.
+    void RejectRotationRequest();
+    // Fails for the software renderer, so that the window manager never asks
+    // for a rotation.
+    bool SetAvailableRotations(const int32_t *degrees, size_t count);
+    wl_surface *CreatePlatformViewSurface(FlutterPlatformViewIdentifier view_id);
+    bool DestroyPlatformViewSurface(FlutterPlatformViewIdentifier view_id);
 
   private:
     int32_t display_width_ = 0;
@@ -35,6 +71,49 @@ namespace flutter
 
     bool valid_ = false;
 
+    FlutterDesktopRenderer renderer_;
+    // False for opaque surface formats, which cannot show platform views.
+    bool surface_has_alpha_ = true;
+    // Only used by the software renderer.
+    std::unique_ptr<ShmSwapchain> swapchain_;
+
+    std::unique_ptr<GLCompositor> compositor_;
+    GLProcResolver proc_resolver_;
+    std::unique_ptr<PlatformViewManager> platform_views_;
+
+    // Distinguishes this display from earlier ones in the per-thread binding
+    // cache, whose EGL handles may have been reused.
+    uint64_t generation_ = 0;
+    std::atomic<uint64_t> make_current_count_{0};
+    std::atomic<uint64_t> make_current_skipped_count_{0};
+
+    bool MakeCurrent(EGLSurface draw, EGLSurface read, EGLContext context);
+    bool ChooseConfig(const SurfaceConfig &surface_config, EGLConfig *config_out) const;
+
+    // Damage of the most recently presented frames, newest first, used to
+    // compute the region of an older back buffer that is out of date.
+    static constexpr size_t kMaxDamageHistory = 4;
+    FlutterRect damage_history_[kMaxDamageHistory] = {};
+    size_t damage_history_size_ = 0;
+    FlutterRect frame_damage_ = {};
+    bool frame_damage_set_ = false;
+
+    bool buffer_age_supported_ = false;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swap_buffers_with_damage_ = nullptr;
+    PFNEGLCREATEIMAGEKHRPROC create_image_ = nullptr;
+    PFNEGLDESTROYIMAGEKHRPROC destroy_image_ = nullptr;
+    std::atomic<uint64_t> full_present_count_{0};
+    std::atomic<uint64_t> partial_present_count_{0};
+
+    FlutterRect GetSurfaceRect() const;
+    int GetBufferAge();
+
+    // |FlutterApplication::RenderDelegate|
+    FlutterRendererType GetRendererType() const override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationPresentSoftware(const void *allocation, size_t row_bytes, size_t height) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationPresentHeldFrame() override;
     // |FlutterApplication::RenderDelegate|
     bool OnApplicationContextMakeCurrent() override;
     // |FlutterApplication::RenderDelegate|
@@ -44,6 +123,23 @@ namespace flutter
     // |FlutterApplication::RenderDelegate|
     bool OnApplicationPresent() override;
     // |FlutterApplication::RenderDelegate|
+    FlutterRect OnApplicationSetFrameDamage(const FlutterRect &damage) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationCreateBackingStore(const FlutterBackingStoreConfig &config,
+                                         FlutterBackingStore *backing_store_out) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationCollectBackingStore(const FlutterBackingStore &backing_store) override;
+    // |FlutterApplication::RenderDelegate|
+    bool OnApplicationPresentLayers(const FlutterLayer **layers, size_t layers_count) override;
+    // |FlutterApplication::RenderDelegate|
+    void OnApplicationFrameDropped() override;
+    // |FlutterApplication::RenderDelegate|
+    void OnApplicationSetBufferRotation(int32_t degrees) override;
+    // |FlutterApplication::RenderDelegate|
+    void *OnApplicationCreateExternalImage(const FlutterDesktopExternalBuffer &buffer) override;
+    // |FlutterApplication::RenderDelegate|
+    void OnApplicationDestroyExternalImage(void *image) override;
+    // |FlutterApplication::RenderDelegate|
     uint32_t OnApplicationGetOnscreenFBO() override;
     // |FlutterApplication::RenderDelegate|
     void *GetProcAddress(const char *) override;
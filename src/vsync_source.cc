@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "vsync_source.h"
+
+#include "logger.h"
+#include "tdm_vsync_source.h"
+#include "timer_vsync_source.h"
+#include "wayland_vsync_source.h"
+
+std::unique_ptr<VsyncSource> VsyncSource::Create(FlutterDesktopVsyncSource type,
+                                                 wl_display *display,
+                                                 wl_surface *surface,
+                                                 double timer_rate)
+{
+  std::unique_ptr<VsyncSource> source;
+
+  if (type == kFlutterDesktopVsyncSourceAuto || type == kFlutterDesktopVsyncSourceTdm)
+  {
+    source = std::make_unique<TdmVsyncSource>();
+    if (source->IsValid())
+    {
+      LogI("Using tdm vblank events for vsync.");
+      return source;
+    }
+  }
+
+  if (type == kFlutterDesktopVsyncSourceAuto || type == kFlutterDesktopVsyncSourceWaylandFrame)
+  {
+    source = std::make_unique<WaylandVsyncSource>(display, surface);
+    if (source->IsValid())
+    {
+      LogI("Using Wayland frame callbacks for vsync.");
+      return source;
+    }
+  }
+
+  // The timer never fails to start in practice, so it is the last resort
+  // whichever source has been asked for.
+  LogI("Using a software timer for vsync.");
+  return std::make_unique<TimerVsyncSource>(timer_rate);
+}
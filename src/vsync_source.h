@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <wayland-client.h>
+
+#include "flutter_tizen.h"
+
+// A provider of vblank events for VsyncWaiter. All methods except the
+// constructor and the destructor are called on the vsync thread.
+class VsyncSource
+{
+public:
+  class Delegate
+  {
+  public:
+    // |sequence| is the vblank counter of the display, or zero if the source
+    // cannot tell how many vblanks have passed since the last event.
+    virtual void OnVblank(uint64_t vblank_nanos, unsigned int sequence) = 0;
+  };
+
+  // Creates the source of the given |type|. kFlutterDesktopVsyncSourceAuto
+  // picks the first usable one of tdm, the Wayland frame callback and the
+  // software timer. |display| and |surface| may be null if there is no window.
+  static std::unique_ptr<VsyncSource> Create(FlutterDesktopVsyncSource type,
+                                             wl_display *display,
+                                             wl_surface *surface,
+                                             double timer_rate);
+
+  virtual ~VsyncSource() = default;
+  virtual bool IsValid() const = 0;
+  void SetDelegate(Delegate *delegate) { delegate_ = delegate; }
+
+  // The fd the vsync thread polls for events of this source.
+  virtual int GetFd() const = 0;
+  // The nominal refresh period, or zero if it is not known in advance.
+  virtual double GetRefreshPeriodNanos() const { return 0; }
+  // Asks for Delegate::OnVblank() to be called once on the next vblank.
+  virtual bool RequestVblank() = 0;
+  // Called right before the vsync thread goes to sleep.
+  virtual void PrepareForPoll() {}
+  // Called every time the vsync thread wakes up. |events| holds the epoll
+  // events of GetFd(), or zero if the thread woke up for another reason.
+  virtual void HandleEvents(uint32_t events) = 0;
+
+protected:
+  Delegate *delegate_ = nullptr;
+};
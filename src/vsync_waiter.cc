@@ -15,152 +15,504 @@
  */
 
 #include "vsync_waiter.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+
 #include "logger.h"
+#include "timer_vsync_source.h"
 
-VsyncWaiter::VsyncWaiter()
+VsyncWaiter::VsyncWaiter(std::unique_ptr<VsyncSource> source,
+                         int64_t phase_offset_nanos,
+                         bool adaptive_phase)
+    : source_(std::move(source)),
+      phase_offset_nanos_(phase_offset_nanos),
+      adaptive_phase_(adaptive_phase)
 {
-  tdm_error ret;
-  client_ = tdm_client_create(&ret);
-  if (ret != TDM_ERROR_NONE)
+  if (!source_ || !source_->IsValid())
+  {
+    LogE("No usable vsync source is available.");
+    return;
+  }
+  source_->SetDelegate(this);
+
+  if (source_->GetRefreshPeriodNanos() > 0)
+  {
+    refresh_period_nanos_ = source_->GetRefreshPeriodNanos();
+  }
+
+  wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (wakeup_fd_ < 0)
   {
-    LogE("tdm_client_create has failed.");
+    LogE("Could not create the vblank wakeup eventfd.");
     return;
   }
 
-  output_ = tdm_client_get_output(client_, const_cast<char *>("default"), &ret);
-  if (ret != TDM_ERROR_NONE)
+  phase_timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (phase_timer_fd_ < 0)
   {
-    LogE("tdm_client_get_output has failed.");
+    LogE("Could not create the vsync phase timerfd.");
     return;
   }
 
-  vblank_ = tdm_client_output_create_vblank(output_, &ret);
-  if (ret != TDM_ERROR_NONE)
+  vblank_timeout_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if (vblank_timeout_fd_ < 0)
   {
-    LogE("tdm_client_output_create_vblank has failed.");
+    LogE("Could not create the vblank timeout timerfd.");
     return;
   }
 
-  std::thread thread(BeginVblankEventLoop, this);
-  thread.join();
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ < 0)
+  {
+    LogE("Could not create the vblank epoll instance.");
+    return;
+  }
+
+  for (int fd : {wakeup_fd_, phase_timer_fd_, vblank_timeout_fd_, source_->GetFd()})
+  {
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+      LogE("Could not watch fd %d for vblank events.", fd);
+      return;
+    }
+  }
+
+  vblank_batons_.reserve(4);
+
+  running_ = true;
+  vblank_thread_ = std::thread(&VsyncWaiter::VblankThreadMain, this);
+}
+
+void VsyncWaiter::VblankThreadMain()
+{
+  int source_fd = source_->GetFd();
+
+  while (running_)
+  {
+    source_->PrepareForPoll();
+
+    epoll_event events[4];
+    int count = epoll_wait(epoll_fd_, events, 4, -1);
+    if (count < 0 && errno != EINTR)
+    {
+      LogE("epoll_wait has failed.");
+      source_->HandleEvents(0);
+      break;
+    }
+
+    uint32_t source_events = 0;
+    bool source_lost = false;
+    for (int i = 0; i < count; i++)
+    {
+      if (events[i].data.fd == source_fd)
+      {
+        source_events = events[i].events;
+        if (source_events & (EPOLLERR | EPOLLHUP))
+        {
+          LogE("The vsync source fd has been closed.");
+          epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, source_fd, nullptr);
+          source_lost = true;
+        }
+      }
+      else if (events[i].data.fd == phase_timer_fd_)
+      {
+        HandlePhaseTimer();
+      }
+      else if (events[i].data.fd == vblank_timeout_fd_)
+      {
+        HandleVblankTimeout();
+      }
+      else
+      {
+        eventfd_t value;
+        eventfd_read(wakeup_fd_, &value);
+        HandleVsyncRequest();
+      }
+    }
+
+    source_->HandleEvents(source_events);
+
+    if (source_lost)
+    {
+      FallBackToTimerSource();
+      source_fd = source_->GetFd();
+    }
+  }
+}
+
+void VsyncWaiter::FallBackToTimerSource()
+{
+  // The vblank requested from the lost source never comes, so the batons
+  // waiting for it are answered by the timer instead.
+  vblank_requested_ = false;
+
+  auto timer_source = std::make_unique<TimerVsyncSource>(1e9 / refresh_period_nanos_);
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = timer_source->GetFd();
+  if (timer_source->IsValid() && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event.data.fd, &event) == 0)
+  {
+    LogW("Falling back to the timer vsync source.");
+    timer_source->SetDelegate(this);
+    source_ = std::move(timer_source);
+  }
+  else
+  {
+    // Requests are then answered right away, which keeps the engine going
+    // without pacing.
+    LogE("Could not fall back to the timer vsync source.");
+    source_usable_ = false;
+  }
+
+  HandleVsyncRequest();
 }
 
-void VsyncWaiter::BeginVblankEventLoop(void *data)
+void VsyncWaiter::HandleVsyncRequest()
 {
-  VsyncWaiter *waiter = reinterpret_cast<VsyncWaiter *>(data);
+  if (!running_ || !engine_)
+  {
+    return;
+  }
 
-  if (!ecore_init())
+  intptr_t baton = pending_baton_.exchange(0);
+  if (baton != 0)
+  {
+    vblank_batons_.push_back(baton);
+  }
+
+  // Batons that arrive while a vblank is already on its way are answered by
+  // that vblank.
+  if (paused_ || vblank_batons_.empty() || vblank_requested_ || delivery_scheduled_)
   {
-    LogE("Could not initialize ecore.");
     return;
   }
 
-  waiter->vblank_ecore_pipe_ = ecore_pipe_add(VblankEventLoopCallback, waiter);
+  uint64_t now = FlutterEngineGetCurrentTime();
+  if (GetPhaseOffset() != 0 &&
+      last_vblank_nanos_ + kMaxPredictionPeriods * refresh_period_nanos_ > now)
+  {
+    // The next vblank can be predicted, so the timer alone decides when the
+    // engine is woken up. The vblank is still requested to keep the
+    // prediction up to date.
+    ScheduleDelivery(now);
+    RequestVblank();
+    return;
+  }
 
-  ecore_main_loop_begin();
-  ecore_shutdown();
+  if (!RequestVblank())
+  {
+    // Hand the batons back anyway so the engine does not stall.
+    DeliverVsync(now, now + refresh_period_nanos_);
+  }
 }
 
-void VsyncWaiter::VblankEventLoopCallback(void *data, void *buffer, unsigned int nbyte)
+void VsyncWaiter::SignalVblankThread()
 {
-  VsyncWaiter *waiter = reinterpret_cast<VsyncWaiter *>(data);
+  if (wakeup_fd_ >= 0)
+  {
+    eventfd_write(wakeup_fd_, 1);
+  }
+}
 
-  int *event_type = reinterpret_cast<int *>(buffer);
-  if ((*event_type) == VBLANK_LOOP_REQUEST)
+bool VsyncWaiter::RequestVblank()
+{
+  if (!vblank_requested_ && source_usable_)
   {
-    waiter->AsyncWaitForVsyncCallback();
+    vblank_requested_ = source_->RequestVblank();
+    if (vblank_requested_)
+    {
+      SetVblankTimeout(FlutterEngineGetCurrentTime() + kVblankTimeoutPeriods * refresh_period_nanos_);
+    }
   }
-  else if ((*event_type) == VBLANK_LOOP_DEL_PIPE)
+  return vblank_requested_;
+}
+
+void VsyncWaiter::SetVblankTimeout(uint64_t deadline_nanos)
+{
+  // A zero deadline disarms the timer.
+  itimerspec spec = {};
+  spec.it_value.tv_sec = deadline_nanos / 1000000000ull;
+  spec.it_value.tv_nsec = deadline_nanos % 1000000000ull;
+  if (timerfd_settime(vblank_timeout_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0)
   {
-    waiter->DeleteVblankEventPipe();
+    LogW("Could not set the vblank timeout.");
   }
 }
 
-void VsyncWaiter::AsyncWaitForVsyncCallback()
+void VsyncWaiter::HandleVblankTimeout()
 {
-  tdm_error ret;
-  ret = tdm_client_vblank_wait(vblank_, 1, TdmClientVblankCallback, this);
-  if (ret != TDM_ERROR_NONE)
+  uint64_t expirations;
+  if (read(vblank_timeout_fd_, &expirations, sizeof(expirations)) != sizeof(expirations) ||
+      !vblank_requested_)
   {
-    LogW("tdm_client_vblank_wait has returned an error.");
     return;
   }
 
-  tdm_client_handle_events(client_);
+  // The source may only produce vblanks for frames that are presented, e.g.
+  // Wayland frame callbacks, so a request made while nothing is drawn may never
+  // be answered. The batons are handed back with a predicted vsync instead,
+  // and the next request asks the source again.
+  vblank_requested_ = false;
+  if (vblank_batons_.empty() || delivery_scheduled_)
+  {
+    return;
+  }
+  uint64_t now = FlutterEngineGetCurrentTime();
+  DeliverVsync(now, now + refresh_period_nanos_);
 }
 
-void VsyncWaiter::DeleteVblankEventPipe()
+void VsyncWaiter::OnVblank(uint64_t vblank_nanos, unsigned int sequence)
 {
-  if (vblank_ecore_pipe_)
+  vblank_requested_ = false;
+  SetVblankTimeout(0);
+  UpdateRefreshPeriod(sequence, vblank_nanos);
+
+  if (vblank_batons_.empty() || delivery_scheduled_)
   {
-    ecore_pipe_del(vblank_ecore_pipe_);
-    vblank_ecore_pipe_ = NULL;
+    return;
   }
 
-  ecore_main_loop_quit();
+  if (GetPhaseOffset() == 0)
+  {
+    last_delivered_vblank_nanos_ = vblank_nanos;
+    DeliverVsync(vblank_nanos, vblank_nanos + refresh_period_nanos_);
+    return;
+  }
+
+  ScheduleDelivery(FlutterEngineGetCurrentTime());
 }
 
-void VsyncWaiter::TdmClientVblankCallback(tdm_client_vblank *vblank,
-                                           tdm_error error,
-                                           unsigned int sequence,
-                                           unsigned int tv_sec,
-                                           unsigned int tv_usec,
-                                           void *user_data)
+int64_t VsyncWaiter::GetPhaseOffset() const
 {
-  VsyncWaiter *waiter = reinterpret_cast<VsyncWaiter *>(user_data);
+  int64_t period = refresh_period_nanos_;
+  int64_t offset = phase_offset_nanos_;
 
-  uint64_t frame_start_time_nanos = tv_sec * 1e9 + tv_usec * 1e3;
-  uint64_t frame_target_time_nanos = 16.6 * 1e6 + frame_start_time_nanos;
+  if (adaptive_phase_)
+  {
+    // Start as late as the recent frames allow. Until a frame has been
+    // measured, stay on the vblank.
+    int64_t duration = frame_duration_nanos_;
+    if (duration == 0)
+    {
+      return 0;
+    }
+    offset = period - duration - static_cast<int64_t>(period * kAdaptivePhaseMargin);
+    return std::max(-period / 2, std::min(offset, period / 2));
+  }
 
-  FlutterEngineOnVsync(waiter->engine_, waiter->baton_, frame_start_time_nanos, frame_target_time_nanos);
+  return std::max(-period, std::min(offset, period));
 }
 
-void VsyncWaiter::AsyncWaitForVsync(intptr_t baton)
+void VsyncWaiter::ScheduleDelivery(uint64_t now)
 {
-  baton_ = baton;
+  // Anchor the frame to the earliest vblank whose offset start time has not
+  // passed yet and that has not been used by a previous frame.
+  int64_t offset = GetPhaseOffset();
+  double period = refresh_period_nanos_;
+  double elapsed = static_cast<double>(now) - offset - static_cast<double>(last_vblank_nanos_);
+  uint64_t vblank = last_vblank_nanos_ + std::max(0.0, std::ceil(elapsed / period)) * period;
+  while (vblank <= last_delivered_vblank_nanos_)
+  {
+    vblank += period;
+  }
 
-  if (!engine_)
+  scheduled_vblank_nanos_ = vblank;
+  scheduled_start_nanos_ = vblank + offset;
+
+  itimerspec spec = {};
+  spec.it_value.tv_sec = scheduled_start_nanos_ / 1000000000ull;
+  spec.it_value.tv_nsec = scheduled_start_nanos_ % 1000000000ull;
+  if (timerfd_settime(phase_timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) < 0)
   {
-    LogW("The Flutter engine has not been initialized.");
+    LogW("Could not arm the vsync phase timer.");
+    DeliverVsync(now, now + refresh_period_nanos_);
     return;
   }
+  delivery_scheduled_ = true;
+}
+
+void VsyncWaiter::HandlePhaseTimer()
+{
+  uint64_t expirations;
+  if (read(phase_timer_fd_, &expirations, sizeof(expirations)) != sizeof(expirations) ||
+      !delivery_scheduled_)
+  {
+    return;
+  }
+
+  delivery_scheduled_ = false;
+  last_delivered_vblank_nanos_ = scheduled_vblank_nanos_;
+
+  // The frame is due when the vblank it is anchored to has been scanned out
+  // for one period, regardless of how far its start has been moved.
+  DeliverVsync(scheduled_start_nanos_, scheduled_vblank_nanos_ + refresh_period_nanos_);
+}
+
+void VsyncWaiter::DeliverVsync(uint64_t frame_start_time_nanos, uint64_t frame_target_time_nanos)
+{
+  for (intptr_t baton : vblank_batons_)
+  {
+    FlutterEngineOnVsync(engine_, baton, frame_start_time_nanos, frame_target_time_nanos);
+  }
+  vblank_batons_.clear();
+
+  last_frame_start_nanos_ = frame_start_time_nanos;
+
+  std::lock_guard<std::mutex> lock(observer_mutex_);
+  if (observer_)
+  {
+    observer_->OnVsync(frame_start_time_nanos, frame_target_time_nanos);
+  }
+}
+
+void VsyncWaiter::SetObserver(Observer *observer)
+{
+  std::lock_guard<std::mutex> lock(observer_mutex_);
+  observer_ = observer;
+}
 
-  if (vblank_ecore_pipe_)
+void VsyncWaiter::OnFramePresented(uint64_t present_time_nanos)
+{
+  // Only the first present after a vsync counts towards the frame duration.
+  uint64_t frame_start = last_frame_start_nanos_.exchange(0);
+  if (!adaptive_phase_ || frame_start == 0 || present_time_nanos <= frame_start)
   {
-    int event_type = VBLANK_LOOP_REQUEST;
-    ecore_pipe_write(vblank_ecore_pipe_, &event_type, sizeof(event_type));
+    return;
   }
 
-  return;
+  // React quickly to slow frames and slowly to fast ones, so that a single
+  // fast frame does not cause the next slow one to miss its vblank.
+  double sample = present_time_nanos - frame_start;
+  double estimate = frame_duration_nanos_;
+  double weight = sample > estimate ? 0.5 : 0.05;
+  frame_duration_nanos_ = estimate == 0 ? sample : estimate + (sample - estimate) * weight;
+}
+
+void VsyncWaiter::UpdateRefreshPeriod(unsigned int sequence, uint64_t vblank_nanos)
+{
+  uint64_t last_vblank_nanos = last_vblank_nanos_;
+  unsigned int elapsed_vblanks = sequence - last_vblank_sequence_;
+
+  last_vblank_nanos_ = vblank_nanos;
+  last_vblank_sequence_ = sequence;
+
+  if (last_vblank_nanos == 0 || vblank_nanos <= last_vblank_nanos)
+  {
+    return;
+  }
+
+  // The waiter only asks for a vblank when a frame is requested, so the
+  // interval may span several refreshes. The sequence numbers tell us how
+  // many; sources without them are assumed to be close to the estimate.
+  double interval = static_cast<double>(vblank_nanos - last_vblank_nanos);
+  if (sequence == 0)
+  {
+    elapsed_vblanks = std::max(1L, std::lround(interval / refresh_period_nanos_));
+  }
+  if (elapsed_vblanks == 0)
+  {
+    return;
+  }
+
+  double sample = interval / elapsed_vblanks;
+  if (std::abs(sample - refresh_period_nanos_) > refresh_period_nanos_ * kRefreshPeriodTolerance)
+  {
+    // Either a glitch or the panel switched modes (e.g. low-power 30 Hz).
+    // Follow the new rate only once it has been observed consistently.
+    if (++refresh_outlier_count_ < kRefreshRateChangeThreshold)
+    {
+      return;
+    }
+    LogI("Refresh period changed: %.2f ms -> %.2f ms", refresh_period_nanos_ / 1e6, sample / 1e6);
+    refresh_period_nanos_ = sample;
+    refresh_outlier_count_ = 0;
+    return;
+  }
+
+  refresh_outlier_count_ = 0;
+  refresh_period_nanos_ += (sample - refresh_period_nanos_) * kRefreshPeriodSmoothing;
+}
+
+void VsyncWaiter::AsyncWaitForVsync(intptr_t baton)
+{
+  // The engine never has more than one vsync request outstanding, so a
+  // non-empty slot means the vblank thread has already been signaled.
+  if (pending_baton_.exchange(baton) != 0)
+  {
+    return;
+  }
+
+  // Requests made before the engine handle is known are flushed by
+  // AsyncWaitForRunEngineSuccess().
+  if (engine_)
+  {
+    SignalVblankThread();
+  }
 }
 
 void VsyncWaiter::AsyncWaitForRunEngineSuccess(FlutterEngine &engine)
 {
   engine_ = engine;
 
-  if (baton_ == 0)
+  if (pending_baton_ != 0)
   {
-    return;
+    SignalVblankThread();
   }
+}
 
-  AsyncWaitForVsync(baton_);
+void VsyncWaiter::Pause()
+{
+  paused_ = true;
+}
+
+void VsyncWaiter::Resume()
+{
+  if (paused_.exchange(false))
+  {
+    // Let the vblank thread pick up the requests held while paused.
+    SignalVblankThread();
+  }
 }
 
 VsyncWaiter::~VsyncWaiter()
 {
-  if (vblank_ecore_pipe_)
+  if (vblank_thread_.joinable())
+  {
+    running_ = false;
+    SignalVblankThread();
+    vblank_thread_.join();
+  }
+
+  if (epoll_fd_ >= 0)
+  {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+
+  if (phase_timer_fd_ >= 0)
   {
-    int event_type = VBLANK_LOOP_DEL_PIPE;
-    ecore_pipe_write(vblank_ecore_pipe_, &event_type, sizeof(event_type));
+    close(phase_timer_fd_);
+    phase_timer_fd_ = -1;
   }
 
-  if (vblank_)
+  if (vblank_timeout_fd_ >= 0)
   {
-    tdm_client_vblank_destroy(vblank_);
+    close(vblank_timeout_fd_);
+    vblank_timeout_fd_ = -1;
   }
 
-  if (client_)
+  if (wakeup_fd_ >= 0)
   {
-    tdm_client_destroy(client_);
+    close(wakeup_fd_);
+    wakeup_fd_ = -1;
   }
 }
@@ -17,38 +17,133 @@
 #pragma once
 
 #include <flutter_embedder.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <tdm_client.h>
-#include <Ecore.h>
+#include <vector>
 
-class VsyncWaiter
+#include "vsync_source.h"
+
+class VsyncWaiter : public VsyncSource::Delegate
 {
 public:
-  VsyncWaiter();
+  class Observer
+  {
+  public:
+    virtual ~Observer() = default;
+    // Called on the vblank thread whenever frames are started.
+    virtual void OnVsync(uint64_t frame_start_time_nanos, uint64_t frame_target_time_nanos) = 0;
+  };
+
+  // A non-zero |phase_offset_nanos| moves the reported frame start away from
+  // the vblank, e.g. a negative offset wakes the engine before the vblank to
+  // give it more time. With |adaptive_phase| the offset is derived from the
+  // measured frame durations instead, starting frames as late as they can
+  // afford to.
+  VsyncWaiter(std::unique_ptr<VsyncSource> source,
+              int64_t phase_offset_nanos = 0,
+              bool adaptive_phase = false);
   ~VsyncWaiter();
   void AsyncWaitForVsync(intptr_t baton);
   void AsyncWaitForRunEngineSuccess(FlutterEngine &engine);
 
+  // While paused, requests are held back and no vblank is asked for, so the
+  // display hardware and the vsync thread can stay idle. Held requests are
+  // serviced when the waiter is resumed.
+  void Pause();
+  void Resume();
+
+  // Called on the render thread when a frame has been presented.
+  void OnFramePresented(uint64_t present_time_nanos);
+
+  // Can be called on any thread. The previous observer is no longer called
+  // once this returns.
+  void SetObserver(Observer *observer);
+
 private:
-  static const int VBLANK_LOOP_REQUEST = 1;
-  static const int VBLANK_LOOP_DEL_PIPE = 2;
-
-  FlutterEngine engine_;
-  intptr_t baton_;
-
-  tdm_client *client_;
-  tdm_client_output *output_;
-  tdm_client_vblank *vblank_;
-  Ecore_Pipe *vblank_ecore_pipe_;
-
-  void AsyncWaitForVsyncCallback();
-  void DeleteVblankEventPipe();
-  static void BeginVblankEventLoop(void *data);
-  static void TdmClientVblankCallback(tdm_client_vblank *vblank,
-                                      tdm_error error,
-                                      unsigned int sequence,
-                                      unsigned int tv_sec,
-                                      unsigned int tv_usec,
-                                      void *user_data);
-  static void VblankEventLoopCallback(void *data, void *buffer, unsigned int nbyte);
+  // Used until the source reports a refresh rate or vblanks have been seen.
+  static constexpr double kDefaultRefreshPeriodNanos = 1e9 / 60;
+  // Weight given to each new interval sample when smoothing the period.
+  static constexpr double kRefreshPeriodSmoothing = 0.125;
+  // Samples further than this fraction away from the estimate are treated as
+  // outliers until enough of them in a row indicate a real rate change.
+  static constexpr double kRefreshPeriodTolerance = 0.2;
+  static constexpr int kRefreshRateChangeThreshold = 3;
+  // Vblank predictions older than this many periods are not trusted.
+  static constexpr int kMaxPredictionPeriods = 4;
+  // The share of the period kept as slack by the adaptive phase.
+  static constexpr double kAdaptivePhaseMargin = 0.1;
+  // Requested vblanks that take longer than this many periods are given up on.
+  static constexpr int kVblankTimeoutPeriods = 2;
+
+  std::atomic<FlutterEngine> engine_{nullptr};
+
+  // A single-slot mailbox written by the engine's vsync callback and drained
+  // by the vblank thread. Zero means that no request is pending. The eventfd
+  // is only signaled when the slot goes from empty to full, so repeated
+  // requests before the vblank thread wakes up cost no extra syscalls.
+  std::atomic<intptr_t> pending_baton_{0};
+  int wakeup_fd_ = -1;
+
+  // Batons waiting for the next vblank. They are all answered by the same
+  // vblank event. Only accessed on the vblank thread.
+  std::vector<intptr_t> vblank_batons_;
+  bool vblank_requested_ = false;
+  int vblank_timeout_fd_ = -1;
+  std::atomic<bool> paused_{false};
+
+  // Replaced by a timer source on the vblank thread if its fd fails.
+  std::unique_ptr<VsyncSource> source_;
+  bool source_usable_ = true;
+
+  std::mutex observer_mutex_;
+  Observer *observer_ = nullptr;
+
+  // The vblank thread lives as long as the waiter does. It sleeps in
+  // epoll_wait() on |wakeup_fd_| and the source fd, so neither new requests
+  // nor shutdown have to wait for a pending vblank to arrive.
+  std::thread vblank_thread_;
+  int epoll_fd_ = -1;
+  std::atomic<bool> running_{false};
+
+  // Refresh period tracking. Only accessed on the vblank thread once it has
+  // been started.
+  double refresh_period_nanos_ = kDefaultRefreshPeriodNanos;
+  uint64_t last_vblank_nanos_ = 0;
+  unsigned int last_vblank_sequence_ = 0;
+  int refresh_outlier_count_ = 0;
+
+  // Phase offset delivery. Batons are handed back when |phase_timer_fd_|
+  // fires at |scheduled_start_nanos_|, on behalf of the vblank at
+  // |scheduled_vblank_nanos_|.
+  const int64_t phase_offset_nanos_;
+  const bool adaptive_phase_;
+  int phase_timer_fd_ = -1;
+  bool delivery_scheduled_ = false;
+  uint64_t scheduled_start_nanos_ = 0;
+  uint64_t scheduled_vblank_nanos_ = 0;
+  // The last vblank a frame was started for, so that no vblank is used twice.
+  uint64_t last_delivered_vblank_nanos_ = 0;
+
+  // Frame duration tracking for the adaptive phase. Written on the render
+  // thread and read on the vblank thread.
+  std::atomic<uint64_t> last_frame_start_nanos_{0};
+  std::atomic<uint64_t> frame_duration_nanos_{0};
+
+  void VblankThreadMain();
+  void HandleVsyncRequest();
+  void SignalVblankThread();
+  bool RequestVblank();
+  void FallBackToTimerSource();
+  void SetVblankTimeout(uint64_t deadline_nanos);
+  void HandleVblankTimeout();
+  void UpdateRefreshPeriod(unsigned int sequence, uint64_t vblank_nanos);
+  int64_t GetPhaseOffset() const;
+  void ScheduleDelivery(uint64_t now);
+  void HandlePhaseTimer();
+  void DeliverVsync(uint64_t frame_start_time_nanos, uint64_t frame_target_time_nanos);
+
+  // |VsyncSource::Delegate|
+  void OnVblank(uint64_t vblank_nanos, unsigned int sequence) override;
 };
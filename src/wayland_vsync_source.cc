@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "wayland_vsync_source.h"
+
+#include <sys/epoll.h>
+#include <flutter_embedder.h>
+
+#include "logger.h"
+
+const wl_callback_listener WaylandVsyncSource::kFrameListener = {
+    WaylandVsyncSource::OnFrameDone,
+};
+
+WaylandVsyncSource::WaylandVsyncSource(wl_display *display, wl_surface *surface)
+    : display_(display)
+{
+  if (!display_ || !surface)
+  {
+    LogE("A Wayland surface is required for frame callbacks.");
+    return;
+  }
+
+  queue_ = wl_display_create_queue(display_);
+  if (!queue_)
+  {
+    LogE("Could not create a Wayland event queue.");
+    return;
+  }
+
+  surface_wrapper_ = reinterpret_cast<wl_surface *>(wl_proxy_create_wrapper(surface));
+  if (!surface_wrapper_)
+  {
+    LogE("Could not create a Wayland surface wrapper.");
+    return;
+  }
+  wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(surface_wrapper_), queue_);
+}
+
+WaylandVsyncSource::~WaylandVsyncSource()
+{
+  if (frame_callback_)
+  {
+    wl_callback_destroy(frame_callback_);
+  }
+
+  if (surface_wrapper_)
+  {
+    wl_proxy_wrapper_destroy(surface_wrapper_);
+  }
+
+  if (queue_)
+  {
+    wl_event_queue_destroy(queue_);
+  }
+}
+
+bool WaylandVsyncSource::IsValid() const { return surface_wrapper_ != nullptr; }
+
+int WaylandVsyncSource::GetFd() const { return wl_display_get_fd(display_); }
+
+bool WaylandVsyncSource::RequestVblank()
+{
+  if (frame_callback_)
+  {
+    return true;
+  }
+
+  // The request is latched by the next commit of the render thread, which
+  // owns the surface state. If nothing is drawn, VsyncWaiter times out.
+  frame_callback_ = wl_surface_frame(surface_wrapper_);
+  wl_callback_add_listener(frame_callback_, &kFrameListener, this);
+  return true;
+}
+
+void WaylandVsyncSource::PrepareForPoll()
+{
+  // The display fd is shared with the platform thread. Announcing the intent
+  // to read makes sure that events for our queue are never read by another
+  // thread while this one is asleep.
+  while (wl_display_prepare_read_queue(display_, queue_) != 0)
+  {
+    wl_display_dispatch_queue_pending(display_, queue_);
+  }
+  wl_display_flush(display_);
+}
+
+void WaylandVsyncSource::HandleEvents(uint32_t events)
+{
+  if (events & EPOLLIN)
+  {
+    wl_display_read_events(display_);
+  }
+  else
+  {
+    wl_display_cancel_read(display_);
+  }
+  wl_display_dispatch_queue_pending(display_, queue_);
+}
+
+void WaylandVsyncSource::OnFrameDone(void *data, wl_callback *callback, uint32_t time)
+{
+  WaylandVsyncSource *source = reinterpret_cast<WaylandVsyncSource *>(data);
+
+  wl_callback_destroy(callback);
+  source->frame_callback_ = nullptr;
+
+  // |time| has an unspecified base, so use the engine clock instead.
+  source->delegate_->OnVblank(FlutterEngineGetCurrentTime(), 0);
+}
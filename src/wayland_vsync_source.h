@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd All Rights Reserved
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include "vsync_source.h"
+
+// Uses wl_surface.frame callbacks of the application window as a frame clock.
+// This works on any Wayland compositor, but the events mark the point where
+// the compositor is ready for a new frame rather than the exact vblank.
+class WaylandVsyncSource : public VsyncSource
+{
+public:
+  WaylandVsyncSource(wl_display *display, wl_surface *surface);
+  virtual ~WaylandVsyncSource();
+  bool IsValid() const override;
+  int GetFd() const override;
+  bool RequestVblank() override;
+  void PrepareForPoll() override;
+  void HandleEvents(uint32_t events) override;
+
+private:
+  wl_display *display_ = nullptr;
+  // Frame callbacks are dispatched on a private queue so that the platform
+  // thread, which dispatches the default queue, never sees them.
+  wl_event_queue *queue_ = nullptr;
+  wl_surface *surface_wrapper_ = nullptr;
+  wl_callback *frame_callback_ = nullptr;
+
+  static void OnFrameDone(void *data, wl_callback *callback, uint32_t time);
+  static const wl_callback_listener kFrameListener;
+};